@@ -4,8 +4,28 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <tuple>
+#include <chrono>
+#include <utility>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "vector.h"
+#include "zone_map.h"
 
 #ifndef LOG
 #define LOG(x) std::cout << x << std::endl
@@ -16,12 +36,122 @@
 
 namespace msh
 {
+    // ----------------------------->     IO_STATS     <-----------------------------
+
+    // Per-phase profile of one IO::read or IO::write call. Read phases are
+    // open, parse, assign and reset; write phases are open, format and close.
+    struct io_stats
+    {
+        std::string operation;
+        std::string file;
+        double open_seconds{0};
+        double parse_seconds{0};
+        double assign_seconds{0};
+        double reset_seconds{0};
+        double format_seconds{0};
+        double close_seconds{0};
+        double total_seconds{0};
+        size_t bytes{0};
+        size_t rows{0};
+        size_t columns{0};
+        // Times a column had to grow while parsing
+        size_t reallocations{0};
+        double rows_per_second{0};
+        // Parse (read) or format (write) throughput
+        double megabytes_per_second{0};
+
+        // Write the profile as one JSON object
+        void dump_json(std::ostream &) const;
+    };
+
+    // ----------------------------->     BATCH     <-----------------------------
+
+    // Outcome of reading one file of a batch
+    struct file_result
+    {
+        std::string file;
+        bool ok{false};
+        std::string error;
+        size_t rows{0};
+        // One entry per column, left empty when the batch is concatenated
+        std::vector<std::vector<double>> columns;
+    };
+
+    // How IO::read_batch spreads the work
+    struct batch_options
+    {
+        // Worker threads, 0 for one per core
+        size_t threads{0};
+        // Files ahead of the current one whose pages are requested from the kernel
+        size_t prefetch{2};
+    };
+
+    // How IO::write_parallel spreads the work
+    struct write_options
+    {
+        // Worker threads, 0 for one per core
+        size_t threads{0};
+        // Rows formatted by a worker into one buffer
+        size_t chunk_rows{65536};
+        // Let every worker pwrite its own buffer at its offset instead of
+        // writing all of them in order from one thread
+        bool positioned{false};
+    };
+
+    // ----------------------------->     SCHEMA     <-----------------------------
+
+    // Column types and delimiter of a file fixed at compile time, e.g.
+    // schema<',', int, double, double>. A ' ' delimiter means any run of
+    // spaces or tabs. Every row sits on its own line.
+    template <char Delimiter, typename... Columns>
+    struct schema
+    {
+        static_assert(sizeof...(Columns) > 0, "a schema needs at least one column");
+
+        static constexpr char delimiter = Delimiter;
+        static constexpr size_t columns = sizeof...(Columns);
+        using row = std::tuple<Columns...>;
+        using storage = std::tuple<msh::vector<Columns>...>;
+
+        // Parse rows until the end of the buffer or the first malformed row,
+        // returns how many rows were appended to the columns and, if asked,
+        // where parsing stopped (the end of the buffer when every row parsed)
+        static size_t parse(const char *, const char *, storage &, const char ** = nullptr);
+
+    private:
+        using sequence = std::index_sequence_for<Columns...>;
+
+        static bool blank(char c) { return c == ' ' || c == '\t'; }
+        template <size_t... I>
+        static void reserve(storage &, size_t, std::index_sequence<I...>);
+        template <size_t... I>
+        static bool parse_row(const char *&, const char *, row &, std::index_sequence<I...>);
+        template <size_t I>
+        static bool parse_field(const char *&, const char *, row &);
+        template <size_t... I>
+        static void append(storage &, row &, size_t, std::index_sequence<I...>);
+    };
+
+    template <typename T>
+    struct is_schema : std::false_type {};
+    template <char Delimiter, typename... Columns>
+    struct is_schema<schema<Delimiter, Columns...>> : std::true_type {};
+
+    // ----------------------------->     IO     <-----------------------------
+
     class IO
     {
     // ------------------->     Variables     <-------------------
     private:
         msh::vector<msh::vector<double>> grid;
         size_t index;
+        bool profiling{false};
+        std::ostream *profile_output{nullptr};
+        io_stats last;
+        std::chrono::steady_clock::time_point mark;
+        size_t zone_block_size{0};
+        std::vector<zone_map<double>> maps;
+        std::string last_error;
 
     // ------------------->      Methods      <-------------------
     public:
@@ -35,9 +165,51 @@ namespace msh
         // Read data from file
         template <typename... Args>
         size_t read(std::string &, Args&...);
+        // Read data from file whose layout is fixed by a schema, one output per column
+        template <typename Schema, typename... Args>
+        typename std::enable_if<is_schema<Schema>::value, size_t>::type read(std::string &, Args&...);
         template <typename... Args>
         void write(std::string &, Args&...);
+        // Write to file with the rows formatted by several threads, same bytes as write
+        template <typename... Args>
+        void write_parallel(std::string &, const write_options &, Args&...);
+        // Read same-layout files concurrently, each into its own columns
+        std::vector<file_result> read_batch(const std::vector<std::string> &, size_t, const batch_options & = batch_options());
+        // Read same-layout files concurrently and append them, in order, to one set of outputs
+        template <typename... Args>
+        std::vector<file_result> read_batch_into(const std::vector<std::string> &, const batch_options &, Args&...);
+
+        // -----> Profiling <-----
+        // Record the phases of every call, and append them as a JSON line to the stream if one is given
+        void enable_profiling(bool = true, std::ostream * = nullptr);
+        // Profile of the last call
+        const io_stats &stats() const;
+        // Why the last read stopped before the end of its file, empty if it read all of it
+        const std::string &error() const;
+
+        // -----> Zone Maps <-----
+        // Build per-block statistics of every column while reading and writing, 0 to stop
+        void enable_zone_maps(size_t block_size = 4096);
+        // Zone maps of the columns of the last read or write
+        const std::vector<zone_map<double>> &zone_maps() const;
     private:
+        // Load the zone maps saved for exactly this version of a file
+        bool load_fresh_zone_maps(const std::string &, size_t);
+        // Start profiling a call
+        void profile_begin(const char *, const std::string &);
+        // Seconds since the previous mark
+        double lap();
+        // Finish the profile and hand it to the output stream
+        void profile_end();
+        // Parse one file of a batch, never terminates the program
+        static void parse_file(file_result &, size_t);
+        // Ask the kernel to start reading a file
+        static void prefetch_file(const std::string &);
+        // Write a whole buffer, at an offset when positioned, false on failure
+        static bool write_buffer(int, const std::string &, off_t, bool);
+        // The value a read gets back from what write prints for it
+        template <typename T>
+        static double written_value(const T &);
         // Release memory
         void reset();
         // Reset size to zero not releasing memory
@@ -46,6 +218,9 @@ namespace msh
         void variadic_assignment() {}
         template <typename Arg, typename... Args>
         void variadic_assignment(Arg&, Args&...);
+        // Assign the parsed schema columns to the outputs
+        template <typename Storage, size_t... I, typename... Args>
+        void schema_assignment(Storage &, std::index_sequence<I...>, Args&...);
     };
 
     // -----> Constructors and Destructor <-----
@@ -60,6 +235,9 @@ namespace msh
     template <typename... Args>
     size_t IO::read(std::string &file_address, Args&... args)
     {
+        if (profiling)
+            profile_begin("read", file_address);
+
         std::fstream File;
         File.open(file_address, std::ios::in);
         if (!File.is_open())
@@ -67,30 +245,118 @@ namespace msh
             std::cout << "Failed to open " << file_address << std::endl;
             exit(1);
         }
+        if (profiling)
+            last.open_seconds = lap();
 
         size_t count {sizeof...(args)};
         grid.reserve(count);
 
         for (size_t i = 0; i < grid.capacity(); ++i)
             grid[i].reserve(1024);
+
+        // Zone maps saved by an earlier write are reused instead of rebuilt
+        bool zoning = zone_block_size > 0 && !load_fresh_zone_maps(file_address, count);
+        if (zoning)
+            maps.assign(count, zone_map<double>(zone_block_size));
         
         for (size_t i = 0, j = 0; File >> grid[i][j]; ++j)
         {
             for (i = 1; i < grid.capacity(); ++i)
                 File >> grid[i][j];
             i = 0;
+            if (zoning && File)
+                for (size_t k = 0; k < count; ++k)
+                    maps[k].add(grid[k][j]);
         }
+        last_error.clear();
+        if (!File.eof())
+            last_error = "Stopped parsing " + file_address + " before its end";
         File.close();
 
         if (grid[0].size() > grid[1].size())
             grid[0].pop();
 
+        if (zone_block_size > 0 && maps[0].size() != grid[0].size())
+            for (size_t k = 0; k < count; ++k)
+            {
+                maps[k] = zone_map<double>(zone_block_size);
+                maps[k].build(grid[k], grid[k].size());
+            }
+
+        if (profiling)
+        {
+            last.parse_seconds = lap();
+            struct stat info;
+            if (stat(file_address.c_str(), &info) == 0)
+                last.bytes = static_cast<size_t>(info.st_size);
+            last.rows = grid[0].size();
+            last.columns = count;
+            for (size_t i = 0; i < grid.capacity(); ++i)
+                last.reallocations += grid[i].reallocations();
+        }
+
         index = 0;
         variadic_assignment(args...);
+        if (profiling)
+            last.assign_seconds = lap();
 
         size_t size_of_array = grid[0].size();
         // soft_reset();
         reset();
+        if (profiling)
+        {
+            last.reset_seconds = lap();
+            last.megabytes_per_second = (last.parse_seconds > 0 ? last.bytes / last.parse_seconds / 1e6 : 0);
+            profile_end();
+        }
+
+        return size_of_array;
+    }
+    // Read data from file whose layout is fixed by a schema, one output per column
+    template <typename Schema, typename... Args>
+    typename std::enable_if<is_schema<Schema>::value, size_t>::type IO::read(std::string &file_address, Args&... args)
+    {
+        static_assert(sizeof...(Args) == Schema::columns, "one output per schema column");
+
+        if (profiling)
+            profile_begin("read", file_address);
+
+        std::ifstream File;
+        File.open(file_address, std::ios::in | std::ios::binary);
+        if (!File.is_open())
+        {
+            std::cout << "Failed to open " << file_address << std::endl;
+            exit(1);
+        }
+        File.seekg(0, std::ios::end);
+        std::string buffer(static_cast<size_t>(File.tellg()), '\0');
+        File.seekg(0, std::ios::beg);
+        File.read(&buffer[0], buffer.size());
+        File.close();
+        if (profiling)
+            last.open_seconds = lap();
+
+        typename Schema::storage columns;
+        const char *stopped = nullptr;
+        size_t size_of_array = Schema::parse(buffer.data(), buffer.data() + buffer.size(), columns, &stopped);
+        last_error.clear();
+        if (stopped != buffer.data() + buffer.size())
+            last_error = "Stopped parsing " + file_address + " at byte " + std::to_string(stopped - buffer.data());
+        if (profiling)
+        {
+            last.parse_seconds = lap();
+            last.bytes = buffer.size();
+            last.rows = size_of_array;
+            last.columns = Schema::columns;
+        }
+
+        schema_assignment(columns, std::index_sequence_for<Args...>(), args...);
+        if (profiling)
+        {
+            last.assign_seconds = lap();
+            last.megabytes_per_second = (last.parse_seconds > 0 ? last.bytes / last.parse_seconds / 1e6 : 0);
+            profile_end();
+        }
 
         return size_of_array;
     }
@@ -98,6 +364,9 @@ namespace msh
     template <typename... Args>
     void IO::write(std::string &file_address, Args&... args)
     {
+        if (profiling)
+            profile_begin("write", file_address);
+
         std::fstream File;
         File.open(file_address, std::ios::out);
         if (!File.is_open())
@@ -105,17 +374,471 @@ namespace msh
             std::cout << "Failed to open " << file_address << std::endl;
             exit(1);
         }
+        if (profiling)
+            last.open_seconds = lap();
 
         auto first_arg = std::get<0>(std::tuple<Args*...>(&args...));
         size_t _size = first_arg->size();
 
+        bool zoning = zone_block_size > 0;
+        if (zoning)
+            maps.assign(sizeof...(args), zone_map<double>(zone_block_size));
+
         for (size_t i = 0; i < _size; ++i)
         {
             int n = 0;
             ((File << (n++ == 0 ? "" : " ") << args[i]), ...);
             File << "\n";
+            if (zoning)
+            {
+                size_t k = 0;
+                ((maps[k++].add(written_value(args[i]))), ...);
+            }
+        }
+        if (profiling)
+        {
+            last.format_seconds = lap();
+            last.bytes = static_cast<size_t>(File.tellp());
+            last.rows = _size;
+            last.columns = sizeof...(args);
         }
         File.close();
+        if (zoning)
+            save_zone_maps(file_address, maps);
+        if (profiling)
+        {
+            last.close_seconds = lap();
+            last.megabytes_per_second = (last.format_seconds > 0 ? last.bytes / last.format_seconds / 1e6 : 0);
+            profile_end();
+        }
+    }
+
+    // Write to file with the rows formatted by several threads. Rows are split
+    // into chunks; in every round each worker formats one chunk into its own
+    // buffer with the same stream formatting as write(), so the bytes match.
+    // The buffers of a round are written while the next round is formatted:
+    // in order by the calling thread, or with positioned set, by each worker
+    // with pwrite at the offset given by the sizes of the chunks before it.
+    // The workers are started once and handed one round at a time.
+    template <typename... Args>
+    void IO::write_parallel(std::string &file_address, const write_options &options, Args&... args)
+    {
+        if (profiling)
+            profile_begin("write", file_address);
+
+        int fd = open(file_address.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd == -1)
+        {
+            std::cout << "Failed to open " << file_address << std::endl;
+            exit(1);
+        }
+        if (profiling)
+            last.open_seconds = lap();
+
+        auto first_arg = std::get<0>(std::tuple<Args*...>(&args...));
+        size_t _size = first_arg->size();
+
+        size_t chunk_rows = std::max<size_t>(1, options.chunk_rows);
+        size_t chunks = (_size + chunk_rows - 1) / chunk_rows;
+        size_t threads = (options.threads ? options.threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+        threads = std::max<size_t>(1, std::min(threads, chunks));
+        size_t rounds = (chunks + threads - 1) / threads;
+
+        // Two sets of buffers: one being formatted, one being written
+        std::vector<std::string> buffers[2] = {std::vector<std::string>(threads), std::vector<std::string>(threads)};
+        std::vector<std::ostringstream> streams(threads);
+        std::vector<off_t> offsets(threads, 0);
+        off_t written = 0;
+        std::atomic<bool> failed{false};
+
+        auto work = [&](size_t t, size_t round)
+        {
+            if (options.positioned && round > 0 && !write_buffer(fd, buffers[(round - 1) % 2][t], offsets[t], true))
+                failed = true;
+
+            std::string &buffer = buffers[round % 2][t];
+            size_t chunk = round * threads + t;
+            if (round == rounds || chunk >= chunks)
+            {
+                buffer.clear();
+                return;
+            }
+            std::ostringstream &stream = streams[t];
+            stream.str(std::string());
+            for (size_t i = chunk * chunk_rows; i < std::min(_size, (chunk + 1) * chunk_rows); ++i)
+            {
+                int n = 0;
+                ((stream << (n++ == 0 ? "" : " ") << args[i]), ...);
+                stream << "\n";
+            }
+            buffer = stream.str();
+        };
+
+        // Rounds are handed over through a generation count: a worker runs
+        // the current round once the generation passes the last one it ran
+        std::mutex mutex;
+        std::condition_variable start, finished;
+        size_t generation = 0, current = 0, busy = 0;
+        bool stop = false;
+        auto worker = [&](size_t t)
+        {
+            for (size_t seen = 0;;)
+            {
+                size_t round;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    start.wait(lock, [&]() { return stop || generation != seen; });
+                    if (stop)
+                        return;
+                    seen = generation;
+                    round = current;
+                }
+                work(t, round);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--busy == 0)
+                    finished.notify_one();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t)
+            pool.emplace_back(worker, t);
+        for (size_t round = 0; round <= rounds; ++round)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                current = round;
+                busy = threads;
+                ++generation;
+            }
+            start.notify_all();
+            if (!options.positioned && round > 0)
+                for (size_t t = 0; t < threads; ++t)
+                    if (!write_buffer(fd, buffers[(round - 1) % 2][t], 0, false))
+                        failed = true;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                finished.wait(lock, [&]() { return busy == 0; });
+            }
+
+            for (size_t t = 0; t < threads; ++t)
+            {
+                offsets[t] = written;
+                written += static_cast<off_t>(buffers[round % 2][t].size());
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        start.notify_all();
+        for (std::thread &thread : pool)
+            thread.join();
+        if (failed)
+        {
+            std::cout << "Failed to write " << file_address << std::endl;
+            exit(1);
+        }
+
+        bool zoning = zone_block_size > 0;
+        if (zoning)
+        {
+            maps.assign(sizeof...(args), zone_map<double>(zone_block_size));
+            for (size_t i = 0; i < _size; ++i)
+            {
+                size_t k = 0;
+                ((maps[k++].add(written_value(args[i]))), ...);
+            }
+        }
+        if (profiling)
+        {
+            last.format_seconds = lap();
+            last.bytes = static_cast<size_t>(written);
+            last.rows = _size;
+            last.columns = sizeof...(args);
+        }
+        close(fd);
+        if (zoning)
+            save_zone_maps(file_address, maps);
+        if (profiling)
+        {
+            last.close_seconds = lap();
+            last.megabytes_per_second = (last.format_seconds > 0 ? last.bytes / last.format_seconds / 1e6 : 0);
+            profile_end();
+        }
+    }
+
+    // -----> Profiling <-----
+    // Record the phases of every call, and append them as a JSON line to the stream if one is given
+    inline void IO::enable_profiling(bool flag, std::ostream *output)
+    {
+        profiling = flag;
+        profile_output = output;
+    }
+    // Profile of the last call
+    inline const io_stats &IO::stats() const
+    {
+        return last;
+    }
+    // Why the last read stopped before the end of its file, empty if it read all of it
+    inline const std::string &IO::error() const
+    {
+        return last_error;
+    }
+    // Start profiling a call
+    inline void IO::profile_begin(const char *operation, const std::string &file_address)
+    {
+        last = io_stats();
+        last.operation = operation;
+        last.file = file_address;
+        mark = std::chrono::steady_clock::now();
+    }
+    // Seconds since the previous mark
+    inline double IO::lap()
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - mark).count();
+        mark = now;
+        return seconds;
+    }
+    // Finish the profile and hand it to the output stream
+    inline void IO::profile_end()
+    {
+        last.total_seconds = last.open_seconds + last.parse_seconds + last.assign_seconds +
+                             last.reset_seconds + last.format_seconds + last.close_seconds;
+        last.rows_per_second = (last.total_seconds > 0 ? last.rows / last.total_seconds : 0);
+        if (profile_output)
+        {
+            last.dump_json(*profile_output);
+            *profile_output << std::endl;
+        }
+    }
+    // -----> Zone Maps <-----
+    // Build per-block statistics of every column while reading and writing,
+    // 0 to stop. Writes save them next to the file (see zone_map_file()) and
+    // reads of that file load them back instead of rebuilding them.
+    inline void IO::enable_zone_maps(size_t block_size)
+    {
+        zone_block_size = block_size;
+        if (block_size == 0)
+            maps.clear();
+    }
+    // Zone maps of the columns of the last read or write
+    inline const std::vector<zone_map<double>> &IO::zone_maps() const
+    {
+        return maps;
+    }
+    // Load the zone maps saved for exactly this version of a file
+    inline bool IO::load_fresh_zone_maps(const std::string &file_address, size_t columns)
+    {
+        return load_zone_maps(file_address, maps, columns) && maps[0].block_size() == zone_block_size;
+    }
+    // Write the profile as one JSON object
+    inline void io_stats::dump_json(std::ostream &os) const
+    {
+        std::string escaped;
+        for (char c : file)
+        {
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                const char digits[] = "0123456789abcdef";
+                escaped += "\\u00";
+                escaped += digits[(c >> 4) & 0xf];
+                escaped += digits[c & 0xf];
+                continue;
+            }
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+
+        os << "{\"operation\": \"" << operation << "\", \"file\": \"" << escaped << "\""
+           << ", \"open_seconds\": " << open_seconds
+           << ", \"parse_seconds\": " << parse_seconds
+           << ", \"assign_seconds\": " << assign_seconds
+           << ", \"reset_seconds\": " << reset_seconds
+           << ", \"format_seconds\": " << format_seconds
+           << ", \"close_seconds\": " << close_seconds
+           << ", \"total_seconds\": " << total_seconds
+           << ", \"bytes\": " << bytes
+           << ", \"rows\": " << rows
+           << ", \"columns\": " << columns
+           << ", \"reallocations\": " << reallocations
+           << ", \"rows_per_second\": " << rows_per_second
+           << ", \"megabytes_per_second\": " << megabytes_per_second << "}";
+    }
+    // Read same-layout files concurrently, each into its own columns. Workers
+    // take the files in order and request the next ones from the kernel while
+    // parsing, so the disk stays busy. A file that cannot be read is reported
+    // in its result instead of ending the program.
+    inline std::vector<file_result> IO::read_batch(const std::vector<std::string> &files, size_t columns, const batch_options &options)
+    {
+        std::vector<file_result> results(files.size());
+        size_t threads = (options.threads ? options.threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+        threads = std::min(threads, files.size());
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]()
+        {
+            for (size_t i; (i = next.fetch_add(1)) < files.size();)
+            {
+                // The files before it were requested by earlier iterations
+                if (options.prefetch > 0 && i + threads + options.prefetch - 1 < files.size())
+                    prefetch_file(files[i + threads + options.prefetch - 1]);
+                results[i].file = files[i];
+                parse_file(results[i], columns);
+            }
+        };
+
+        if (options.prefetch > 0)
+            for (size_t j = 0; j < std::min(files.size(), threads + options.prefetch - 1); ++j)
+                prefetch_file(files[j]);
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread &thread : pool)
+            thread.join();
+
+        return results;
+    }
+    // Read same-layout files concurrently and append them, in order, to one
+    // set of outputs. Files that failed are left out.
+    template <typename... Args>
+    std::vector<file_result> IO::read_batch_into(const std::vector<std::string> &files, const batch_options &options, Args&... args)
+    {
+        size_t count {sizeof...(args)};
+        std::vector<file_result> results = read_batch(files, count, options);
+
+        size_t total = 0;
+        for (const file_result &result : results)
+            if (result.ok)
+                total += result.rows;
+
+        grid.reserve(count);
+        for (size_t i = 0; i < grid.capacity(); ++i)
+        {
+            grid[i].reserve(total + 1);
+            for (file_result &result : results)
+            {
+                if (!result.ok || result.columns.size() <= i)
+                    continue;
+                for (size_t j = 0; j < result.rows; ++j)
+                    grid[i][grid[i].size()] = result.columns[i][j];
+                std::vector<double>().swap(result.columns[i]);
+            }
+        }
+        for (file_result &result : results)
+            result.columns.clear();
+
+        index = 0;
+        variadic_assignment(args...);
+        reset();
+
+        return results;
+    }
+    // Parse one file of a batch with the rules of IO::read: whitespace
+    // separated numbers, a leading '+' allowed, and a trailing incomplete row
+    // is dropped. Text that is not a number fails the file, with its byte
+    // offset in the error; the rows before it are kept in the result.
+    inline void IO::parse_file(file_result &result, size_t columns)
+    {
+        std::ifstream File;
+        File.open(result.file, std::ios::in | std::ios::binary);
+        if (!File.is_open())
+        {
+            result.error = "Failed to open " + result.file;
+            return;
+        }
+        File.seekg(0, std::ios::end);
+        std::streamoff length = File.tellg();
+        if (length < 0)
+        {
+            result.error = "Failed to read " + result.file;
+            return;
+        }
+        std::string buffer(static_cast<size_t>(length), '\0');
+        File.seekg(0, std::ios::beg);
+        if (!File.read(&buffer[0], buffer.size()))
+        {
+            result.error = "Failed to read " + result.file;
+            return;
+        }
+        File.close();
+
+        result.ok = true;
+        if (columns == 0)
+            return;
+        result.columns.assign(columns, std::vector<double>());
+        const char *p = buffer.data();
+        const char *end = p + buffer.size();
+        for (size_t column = 0;; column = (column + 1) % columns)
+        {
+            while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+                ++p;
+            if (p == end)
+                break;
+            // from_chars does not take the sign operator>> accepts
+            const char *number = p;
+            if (*p == '+' && p + 1 < end && p[1] != '-' && p[1] != '+')
+                ++p;
+            double value;
+            std::from_chars_result parsed = std::from_chars(p, end, value);
+            if (parsed.ec != std::errc())
+            {
+                result.ok = false;
+                result.error = "Failed to parse " + result.file + " at byte " + std::to_string(number - buffer.data());
+                break;
+            }
+            p = parsed.ptr;
+            result.columns[column].push_back(value);
+        }
+
+        result.rows = result.columns[columns - 1].size();
+        for (std::vector<double> &column : result.columns)
+            column.resize(result.rows);
+    }
+    // Ask the kernel to start reading a file
+    inline void IO::prefetch_file(const std::string &file_address)
+    {
+        int fd = open(file_address.c_str(), O_RDONLY);
+        if (fd == -1)
+            return;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+    // Write a whole buffer, at an offset when positioned, false on failure
+    inline bool IO::write_buffer(int fd, const std::string &buffer, off_t offset, bool positioned)
+    {
+        const char *p = buffer.data();
+        size_t left = buffer.size();
+        while (left > 0)
+        {
+            ssize_t bytes = (positioned ? pwrite(fd, p, left, offset) : ::write(fd, p, left));
+            if (bytes < 0 && errno == EINTR)
+                continue;
+            if (bytes <= 0)
+                return false;
+            p += bytes;
+            left -= static_cast<size_t>(bytes);
+            offset += bytes;
+        }
+        return true;
+    }
+    // The value a read gets back from what write prints for it. Streams print
+    // floating point values like %g, rounded to 6 significant digits, so the
+    // zone maps of a written file are built from those digits.
+    template <typename T>
+    double IO::written_value(const T &value)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%g", static_cast<double>(value));
+            return std::strtod(text, nullptr);
+        }
+        else
+            return static_cast<double>(value);
     }
     // Release memory
     void IO::reset()
@@ -139,6 +862,98 @@ namespace msh
         ++index;
         variadic_assignment(args...);
     }
+    // Assign the parsed schema columns to the outputs
+    template <typename Storage, size_t... I, typename... Args>
+    void IO::schema_assignment(Storage &columns, std::index_sequence<I...>, Args&... args)
+    {
+        ((args = std::get<I>(columns)), ...);
+    }
+
+    // ----------------------------->     SCHEMA     <-----------------------------
+    // Parse rows until the end of the buffer or the first malformed row,
+    // returns how many rows were appended to the columns and, if asked,
+    // where parsing stopped (the end of the buffer when every row parsed)
+    template <char Delimiter, typename... Columns>
+    size_t schema<Delimiter, Columns...>::parse(const char *p, const char *end, storage &columns, const char **stopped)
+    {
+        // One line per row, so the line count bounds the column sizes
+        size_t lines = 1;
+        for (const char *q = p; (q = static_cast<const char *>(std::memchr(q, '\n', end - q))); ++q)
+            ++lines;
+        reserve(columns, lines, sequence());
+
+        size_t rows = 0;
+        for (;;)
+        {
+            while (p < end && (blank(*p) || *p == '\n' || *p == '\r'))
+                ++p;
+            if (p == end)
+                break;
+
+            row values;
+            const char *start = p;
+            if (!parse_row(p, end, values, sequence()))
+            {
+                p = start;
+                break;
+            }
+            while (p < end && *p != '\n')
+                ++p;
+
+            append(columns, values, rows, sequence());
+            ++rows;
+        }
+        if (stopped)
+            *stopped = p;
+        return rows;
+    }
+
+    template <char Delimiter, typename... Columns>
+    template <size_t... I>
+    void schema<Delimiter, Columns...>::reserve(storage &columns, size_t count, std::index_sequence<I...>)
+    {
+        (std::get<I>(columns).reserve(count), ...);
+    }
+
+    // Every field is parsed by the code for its own type, with no loop over columns
+    template <char Delimiter, typename... Columns>
+    template <size_t... I>
+    bool schema<Delimiter, Columns...>::parse_row(const char *&p, const char *end, row &values, std::index_sequence<I...>)
+    {
+        return (parse_field<I>(p, end, values) && ...);
+    }
+
+    template <char Delimiter, typename... Columns>
+    template <size_t I>
+    bool schema<Delimiter, Columns...>::parse_field(const char *&p, const char *end, row &values)
+    {
+        while (p < end && blank(*p))
+            ++p;
+        if (I > 0 && Delimiter != ' ')
+        {
+            if (p == end || *p != Delimiter)
+                return false;
+            ++p;
+            while (p < end && blank(*p))
+                ++p;
+        }
+
+        // from_chars does not take the sign operator>> accepts
+        if (p < end && *p == '+' && p + 1 < end && p[1] != '-' && p[1] != '+')
+            ++p;
+        std::from_chars_result result = std::from_chars(p, end, std::get<I>(values));
+        if (result.ec != std::errc())
+            return false;
+        p = result.ptr;
+        return true;
+    }
+
+    template <char Delimiter, typename... Columns>
+    template <size_t... I>
+    void schema<Delimiter, Columns...>::append(storage &columns, row &values, size_t index, std::index_sequence<I...>)
+    {
+        ((std::get<I>(columns)[index] = std::get<I>(values)), ...);
+    }
 } // namespace msh
 
 #endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#ifndef MSH_BENCHMARK_H
+#define MSH_BENCHMARK_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+namespace msh
+{
+namespace bench
+{
+    // ----------------------------->     RESULT     <-----------------------------
+
+    // One measured case, written in the Google Benchmark JSON layout
+    struct result
+    {
+        std::string name;
+        size_t iterations;
+        double real_time;
+        double cpu_time;
+        double items_per_second;
+        double bytes_per_second;
+    };
+
+    // Keep the compiler from optimizing a computed value away
+    template <typename T>
+    inline void do_not_optimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // ----------------------------->     RUNNER     <-----------------------------
+
+    // Repeats each case until it ran for at least min_time seconds and
+    // collects the per-iteration time. Command line:
+    //   --filter=<substring>  only run cases whose name contains it
+    //   --min_time=<seconds>  minimum measuring time per case (default 0.5)
+    //   --max_elements=<n>    largest element count for size sweeps
+    //   --out=<file>          write the JSON there instead of stdout
+    class runner
+    {
+    // ------------------->     Variables     <-------------------
+    private:
+        std::vector<result> results;
+        std::string filter;
+        std::string out;
+        double min_time{0.5};
+        size_t max_elements{10000000};
+
+    // ------------------->      Methods      <-------------------
+    public:
+        // -----> Constructors and Destructor <-----
+        runner(int, char **);
+
+        // -----> Getters <-----
+        // Largest element count for size sweeps
+        size_t max_size() const { return max_elements; }
+
+        // -----> Other Methods <-----
+        // Measure fn(), which processes the given items and bytes per call
+        template <typename F>
+        void run(const std::string &, size_t, size_t, F);
+        // Write all the results as JSON
+        void report() const;
+    };
+
+    // -----> Constructors and Destructor <-----
+    inline runner::runner(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg.rfind("--filter=", 0) == 0)
+                filter = arg.substr(9);
+            else if (arg.rfind("--min_time=", 0) == 0)
+                min_time = std::atof(arg.substr(11).c_str());
+            else if (arg.rfind("--max_elements=", 0) == 0)
+                max_elements = std::strtoull(arg.substr(15).c_str(), nullptr, 10);
+            else if (arg.rfind("--out=", 0) == 0)
+                out = arg.substr(6);
+            else
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    // -----> Other Methods <-----
+    // Measure fn(), which processes the given items and bytes per call
+    template <typename F>
+    void runner::run(const std::string &name, size_t items, size_t bytes, F fn)
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+            return;
+
+        // Warm up once, then double the iterations until the run is long enough
+        fn();
+        size_t iterations = 1;
+        for (;;)
+        {
+            std::clock_t cpu_start = std::clock();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+                fn();
+            double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+            if (real >= min_time || iterations >= (size_t(1) << 30))
+            {
+                results.push_back({name, iterations, real / iterations * 1e9, cpu / iterations * 1e9,
+                                   items * iterations / real, bytes * iterations / real});
+                std::cerr << name << ": " << real / iterations * 1e9 << " ns" << std::endl;
+                return;
+            }
+            iterations *= 2;
+        }
+    }
+
+    // Write all the results as JSON
+    inline void runner::report() const
+    {
+        std::ofstream file;
+        if (!out.empty())
+        {
+            file.open(out);
+            if (!file.is_open())
+            {
+                std::cerr << "Failed to open " << out << std::endl;
+                exit(1);
+            }
+        }
+        std::ostream &os = (out.empty() ? std::cout : file);
+
+        char host[256] = "";
+        gethostname(host, sizeof(host) - 1);
+        std::time_t now = std::time(nullptr);
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        os << "{\n  \"context\": {\n"
+           << "    \"date\": \"" << date << "\",\n"
+           << "    \"host_name\": \"" << host << "\",\n"
+           << "    \"num_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n"
+           << "    \"library_build_type\": \""
+#ifdef NDEBUG
+           << "release"
+#else
+           << "debug"
+#endif
+           << "\"\n  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const result &r = results[i];
+            os << (i == 0 ? "\n" : ",\n")
+               << "    {\n"
+               << "      \"name\": \"" << r.name << "\",\n"
+               << "      \"run_type\": \"iteration\",\n"
+               << "      \"iterations\": " << r.iterations << ",\n"
+               << "      \"real_time\": " << r.real_time << ",\n"
+               << "      \"cpu_time\": " << r.cpu_time << ",\n"
+               << "      \"time_unit\": \"ns\",\n"
+               << "      \"items_per_second\": " << r.items_per_second << ",\n"
+               << "      \"bytes_per_second\": " << r.bytes_per_second << "\n"
+               << "    }";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    // ----------------------------->     TEMP_FILE     <-----------------------------
+
+    // Unique file name under /tmp that is removed when the object goes away
+    class temp_file
+    {
+    private:
+        std::string _path;
+    public:
+        temp_file()
+        {
+            char name[] = "/tmp/msh_bench_XXXXXX";
+            int fd = mkstemp(name);
+            if (fd == -1)
+            {
+                std::cerr << "Failed to create a temporary file" << std::endl;
+                exit(1);
+            }
+            close(fd);
+            _path = name;
+        }
+        temp_file(const temp_file &) = delete;
+        temp_file &operator=(const temp_file &) = delete;
+        ~temp_file() { std::remove(_path.c_str()); }
+
+        std::string &path() { return _path; }
+    };
+} // namespace bench
+} // namespace msh
+
+#endif
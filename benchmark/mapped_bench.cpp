@@ -0,0 +1,94 @@
+// Sequential and random access on a file-backed msh::shared_vector, against
+// a heap-backed one of the same size. Results are printed as JSON on stdout.
+//
+//   g++ -O2 -DNDEBUG -std=c++17 -I.. mapped_bench.cpp -o mapped_bench -pthread
+//
+// To measure a dataset larger than memory, run it under a memory cap with
+// TMPDIR on a disk (not tmpfs), e.g. 4 GB of doubles under a 1 GB cap
+// (one command line):
+//
+//   TMPDIR=/var/tmp systemd-run --user --scope -p MemoryMax=1G ./mapped_bench
+//       --max_elements=500000000 --min_time=0 > mapped_bench.json
+//
+// Add --filter=mapped to skip the heap cases, which the cap would kill.
+
+#include <string>
+#include "benchmark.h"
+#include "../shared_vector.h"
+
+namespace
+{
+    const size_t random_reads = 1000000;
+
+    // Fill, scan and probe one vector of n elements
+    void access_cases(msh::bench::runner &runner, const std::string &prefix, msh::shared_vector<double> &v, size_t n)
+    {
+        std::string suffix = "/" + std::to_string(n);
+
+        runner.run(prefix + "_sequential_write" + suffix, n, n * sizeof(double), [&v, n]()
+        {
+            double *data = v.get();
+            for (size_t i = 0; i < n; ++i)
+                data[i] = static_cast<double>(i);
+            msh::bench::do_not_optimize(data);
+        });
+        runner.run(prefix + "_sequential_read" + suffix, n, n * sizeof(double), [&v, n]()
+        {
+            const double *data = v.get();
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += data[i];
+            msh::bench::do_not_optimize(sum);
+        });
+        runner.run(prefix + "_random_read" + suffix, random_reads, random_reads * sizeof(double), [&v, n]()
+        {
+            const double *data = v.get();
+            double sum = 0;
+            uint64_t state = 88172645463325252ull;
+            for (size_t i = 0; i < random_reads; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                sum += data[state % n];
+            }
+            msh::bench::do_not_optimize(sum);
+        });
+    }
+
+    void append_case(msh::bench::runner &runner, bool mapped, size_t n)
+    {
+        std::string name = std::string(mapped ? "mapped" : "heap") + "_append/" + std::to_string(n);
+        runner.run(name, n, n * sizeof(double), [mapped, n]()
+        {
+            msh::shared_vector<double> v = (mapped ? msh::shared_vector<double>::create_mapped("", 1)
+                                                   : msh::shared_vector<double>(1));
+            for (size_t i = 0; i < n; ++i)
+            {
+                double value = static_cast<double>(i);
+                v.emplace_back(value);
+            }
+            msh::bench::do_not_optimize(v.get());
+        });
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    msh::bench::runner runner(argc, argv);
+    size_t n = runner.max_size();
+
+    append_case(runner, true, n);
+    append_case(runner, false, n);
+    {
+        msh::shared_vector<double> mapped = msh::shared_vector<double>::create_mapped("", n);
+        access_cases(runner, "mapped", mapped, n);
+    }
+    {
+        msh::shared_vector<double> heap(n);
+        access_cases(runner, "heap", heap, n);
+    }
+
+    runner.report();
+    return 0;
+}
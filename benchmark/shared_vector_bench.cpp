@@ -0,0 +1,147 @@
+// Benchmarks for msh::shared_vector against std::vector and std::shared_ptr.
+// Results are printed as JSON on stdout.
+//
+//   g++ -O2 -DNDEBUG -std=c++17 -I.. shared_vector_bench.cpp -o shared_vector_bench -pthread
+//   ./shared_vector_bench --min_time=0.5 --max_elements=1000000000 > shared_vector_bench.json
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "benchmark.h"
+#include "../shared_vector.h"
+
+namespace
+{
+    void append_cases(msh::bench::runner &runner, size_t n)
+    {
+        std::string suffix = "/" + std::to_string(n);
+
+        const std::pair<const char *, msh::growth_policy> policies[] = {
+            {"2x", msh::growth_policy(2, 1)},
+            {"1.5x", msh::growth_policy(3, 2)},
+            {"2x_page", msh::growth_policy(2, 1, msh::growth_policy::page_size())},
+        };
+        for (const auto &policy : policies)
+        {
+            msh::growth_policy growth = policy.second;
+            runner.run(std::string("msh_shared_vector_append_") + policy.first + suffix, n, n * sizeof(double), [n, growth]()
+            {
+                msh::shared_vector<double> v(1);
+                v.set_growth(growth);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    double value = static_cast<double>(i);
+                    v.emplace_back(value);
+                }
+                msh::bench::do_not_optimize(v.get());
+            });
+        }
+        runner.run("msh_shared_vector_index_append" + suffix, n, n * sizeof(double), [n]()
+        {
+            msh::shared_vector<double> v(1);
+            v.set_permission(true);
+            for (size_t i = 0; i < n; ++i)
+                v[i] = static_cast<double>(i);
+            msh::bench::do_not_optimize(v.get());
+        });
+        runner.run("std_vector_append" + suffix, n, n * sizeof(double), [n]()
+        {
+            std::vector<double> v;
+            for (size_t i = 0; i < n; ++i)
+                v.push_back(static_cast<double>(i));
+            msh::bench::do_not_optimize(v.data());
+        });
+    }
+
+    void access_cases(msh::bench::runner &runner, size_t n)
+    {
+        std::string suffix = "/" + std::to_string(n);
+
+        msh::shared_vector<double> source(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double value = i * 0.25;
+            source.emplace_back(value);
+        }
+        std::vector<double> std_source(source.get(), source.get() + n);
+
+        runner.run("msh_shared_vector_indexed_read" + suffix, n, n * sizeof(double), [&source, n]()
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += source[i];
+            msh::bench::do_not_optimize(sum);
+        });
+        runner.run("std_vector_indexed_read" + suffix, n, n * sizeof(double), [&std_source, n]()
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += std_source[i];
+            msh::bench::do_not_optimize(sum);
+        });
+
+        // Every call moves n elements to a block of a different capacity
+        bool wide = false;
+        runner.run("msh_shared_vector_realloc_growth" + suffix, n, n * sizeof(double), [&source, &wide, n]()
+        {
+            source.reserve(wide ? n : 2 * n);
+            wide = !wide;
+            msh::bench::do_not_optimize(source.get());
+        });
+        runner.run("std_vector_realloc_growth" + suffix, n, n * sizeof(double), [&std_source, n]()
+        {
+            std::vector<double> grown;
+            grown.reserve(2 * n);
+            grown.insert(grown.end(), std_source.begin(), std_source.end());
+            msh::bench::do_not_optimize(grown.data());
+        });
+    }
+
+    void refcount_cases(msh::bench::runner &runner)
+    {
+        const size_t copies = 1000;
+
+        msh::shared_vector<double> source(16);
+        runner.run("msh_shared_vector_copy_release", copies, 0, [&source]()
+        {
+            for (size_t i = 0; i < copies; ++i)
+            {
+                msh::shared_vector<double> copy(source);
+                msh::bench::do_not_optimize(copy.use_count());
+            }
+        });
+        runner.run("msh_shared_vector_assign_release", copies, 0, [&source]()
+        {
+            msh::shared_vector<double> copy;
+            for (size_t i = 0; i < copies; ++i)
+            {
+                copy = source;
+                msh::bench::do_not_optimize(copy.use_count());
+            }
+        });
+
+        std::shared_ptr<std::vector<double>> std_source = std::make_shared<std::vector<double>>(16);
+        runner.run("std_shared_ptr_copy_release", copies, 0, [&std_source]()
+        {
+            for (size_t i = 0; i < copies; ++i)
+            {
+                std::shared_ptr<std::vector<double>> copy(std_source);
+                msh::bench::do_not_optimize(copy.use_count());
+            }
+        });
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    msh::bench::runner runner(argc, argv);
+
+    for (size_t n = 1000; n <= runner.max_size(); n *= 10)
+        append_cases(runner, n);
+    for (size_t n = 1000; n <= runner.max_size(); n *= 10)
+        access_cases(runner, n);
+    refcount_cases(runner);
+
+    runner.report();
+    return 0;
+}
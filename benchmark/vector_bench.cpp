@@ -0,0 +1,253 @@
+// Benchmarks for msh::vector, msh::array and msh::IO against std::vector and
+// std::ifstream/std::ofstream. Results are printed as JSON on stdout.
+//
+//   g++ -O2 -DNDEBUG -std=c++17 -I.. vector_bench.cpp -o vector_bench -pthread
+//   ./vector_bench --min_time=0.5 --max_elements=10000000 > vector_bench.json
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <tuple>
+#include <utility>
+#include <thread>
+#include <algorithm>
+#include "benchmark.h"
+#include "../IO.h"
+
+namespace
+{
+    const size_t columns = 4;
+
+    // Fill a column with values that do not print as integers
+    void fill(msh::vector<double> &column, size_t count, double offset)
+    {
+        column.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            column[i] = offset + i * 0.25;
+    }
+
+    void vector_cases(msh::bench::runner &runner, size_t n)
+    {
+        std::string suffix = "/" + std::to_string(n);
+
+        runner.run("msh_vector_append" + suffix, n, n * sizeof(double), [n]()
+        {
+            msh::vector<double> v(1);
+            for (size_t i = 0; i < n; ++i)
+                v[i] = static_cast<double>(i);
+            msh::bench::do_not_optimize(v.get());
+        });
+        runner.run("std_vector_append" + suffix, n, n * sizeof(double), [n]()
+        {
+            std::vector<double> v;
+            for (size_t i = 0; i < n; ++i)
+                v.push_back(static_cast<double>(i));
+            msh::bench::do_not_optimize(v.data());
+        });
+
+        msh::vector<double> source;
+        fill(source, n, 0);
+        std::vector<double> std_source(source.get(), source.get() + n);
+
+        runner.run("msh_vector_indexed_read" + suffix, n, n * sizeof(double), [&source, n]()
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += source[i];
+            msh::bench::do_not_optimize(sum);
+        });
+        runner.run("std_vector_indexed_read" + suffix, n, n * sizeof(double), [&std_source, n]()
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += std_source[i];
+            msh::bench::do_not_optimize(sum);
+        });
+
+        runner.run("msh_vector_copy_assign" + suffix, n, n * sizeof(double), [&source]()
+        {
+            msh::vector<double> copy;
+            copy = source;
+            msh::bench::do_not_optimize(copy.get());
+        });
+        runner.run("std_vector_copy_assign" + suffix, n, n * sizeof(double), [&std_source]()
+        {
+            std::vector<double> copy;
+            copy = std_source;
+            msh::bench::do_not_optimize(copy.data());
+        });
+
+        // Every call moves n elements to a block of a different capacity
+        bool wide = false;
+        runner.run("msh_vector_realloc_growth" + suffix, n, n * sizeof(double), [&source, &wide, n]()
+        {
+            source.reserve(wide ? n : 2 * n);
+            wide = !wide;
+            msh::bench::do_not_optimize(source.get());
+        });
+        runner.run("std_vector_realloc_growth" + suffix, n, n * sizeof(double), [&std_source, n]()
+        {
+            std::vector<double> grown;
+            grown.reserve(2 * n);
+            grown.insert(grown.end(), std_source.begin(), std_source.end());
+            msh::bench::do_not_optimize(grown.data());
+        });
+    }
+
+    void io_cases(msh::bench::runner &runner, size_t rows)
+    {
+        std::string suffix = "/" + std::to_string(rows);
+
+        msh::vector<double> a, b, c, d;
+        fill(a, rows, 0);
+        fill(b, rows, 1);
+        fill(c, rows, 2);
+        fill(d, rows, 3);
+        msh::array<double> out_a, out_b, out_c, out_d;
+        out_a = a;
+        out_b = b;
+        out_c = c;
+        out_d = d;
+
+        msh::bench::temp_file file;
+        msh::IO io;
+        io.write(file.path(), out_a, out_b, out_c, out_d);
+
+        std::ifstream probe(file.path(), std::ios::binary | std::ios::ate);
+        size_t bytes = static_cast<size_t>(probe.tellg());
+        probe.close();
+
+        runner.run("msh_io_write" + suffix, rows, bytes, [&]()
+        {
+            io.write(file.path(), out_a, out_b, out_c, out_d);
+        });
+        runner.run("std_ofstream_write" + suffix, rows, bytes, [&]()
+        {
+            std::ofstream stream(file.path());
+            for (size_t i = 0; i < rows; ++i)
+                stream << out_a[i] << ' ' << out_b[i] << ' ' << out_c[i] << ' ' << out_d[i] << '\n';
+        });
+
+        runner.run("msh_io_read" + suffix, rows, bytes, [&]()
+        {
+            msh::array<double> in_a, in_b, in_c, in_d;
+            size_t count = io.read(file.path(), in_a, in_b, in_c, in_d);
+            msh::bench::do_not_optimize(count);
+        });
+        runner.run("std_ifstream_read" + suffix, rows, bytes, [&]()
+        {
+            std::ifstream stream(file.path());
+            std::vector<double> in[columns];
+            double value;
+            for (size_t j = 0; stream >> value; j = (j + 1) % columns)
+                in[j].push_back(value);
+            msh::bench::do_not_optimize(in[0].data());
+        });
+    }
+
+    // IO::write_parallel at 1, 2, 4... threads up to the core count, with
+    // the buffers written in order and with pwrite
+    void io_write_scaling_cases(msh::bench::runner &runner, size_t rows)
+    {
+        msh::vector<double> a, b, c, d;
+        fill(a, rows, 0);
+        fill(b, rows, 1);
+        fill(c, rows, 2);
+        fill(d, rows, 3);
+        msh::array<double> out_a, out_b, out_c, out_d;
+        out_a = a;
+        out_b = b;
+        out_c = c;
+        out_d = d;
+
+        msh::bench::temp_file file;
+        msh::IO io;
+        io.write(file.path(), out_a, out_b, out_c, out_d);
+        std::ifstream probe(file.path(), std::ios::binary | std::ios::ate);
+        size_t bytes = static_cast<size_t>(probe.tellg());
+        probe.close();
+
+        size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+        for (size_t threads = 1;; threads = std::min(2 * threads, cores))
+        {
+            std::string suffix = "/" + std::to_string(threads) + "x" + std::to_string(rows);
+            for (bool positioned : {false, true})
+            {
+                msh::write_options options;
+                options.threads = threads;
+                options.positioned = positioned;
+                runner.run(std::string(positioned ? "msh_io_pwrite_parallel" : "msh_io_write_parallel") + suffix, rows, bytes, [&]()
+                {
+                    io.write_parallel(file.path(), options, out_a, out_b, out_c, out_d);
+                });
+            }
+            if (threads == cores)
+                break;
+        }
+    }
+
+    template <size_t, typename T>
+    using repeat = T;
+
+    // Schema of a file with only double columns, one per index
+    template <size_t... I>
+    msh::schema<' ', repeat<I, double>...> double_schema(std::index_sequence<I...>);
+
+    // Output columns for a read of N columns
+    template <size_t... I>
+    std::tuple<repeat<I, msh::array<double>>...> double_columns(std::index_sequence<I...>);
+
+    template <size_t N>
+    void io_schema_cases(msh::bench::runner &runner, size_t rows)
+    {
+        using sequence = std::make_index_sequence<N>;
+        using schema = decltype(double_schema(sequence()));
+        using columns = decltype(double_columns(sequence()));
+        std::string suffix = "/" + std::to_string(N) + "x" + std::to_string(rows);
+
+        msh::bench::temp_file file;
+        {
+            std::ofstream stream(file.path());
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < N; ++j)
+                    stream << (j == 0 ? "" : " ") << i * 0.25 + j << (j + 1 == N ? "\n" : "");
+        }
+        std::ifstream probe(file.path(), std::ios::binary | std::ios::ate);
+        size_t bytes = static_cast<size_t>(probe.tellg());
+        probe.close();
+
+        msh::IO io;
+        runner.run("msh_io_read_generic" + suffix, rows, bytes, [&]()
+        {
+            columns out;
+            size_t count = std::apply([&](auto &... column) { return io.read(file.path(), column...); }, out);
+            msh::bench::do_not_optimize(count);
+        });
+        runner.run("msh_io_read_schema" + suffix, rows, bytes, [&]()
+        {
+            columns out;
+            size_t count = std::apply([&](auto &... column) { return io.read<schema>(file.path(), column...); }, out);
+            msh::bench::do_not_optimize(count);
+        });
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    msh::bench::runner runner(argc, argv);
+
+    for (size_t n = 1000; n <= runner.max_size(); n *= 10)
+        vector_cases(runner, n);
+    for (size_t rows = 1000; rows <= runner.max_size() / 10; rows *= 10)
+        io_cases(runner, rows);
+    io_write_scaling_cases(runner, runner.max_size() / 10);
+    for (size_t rows = 1000; rows <= runner.max_size() / 100; rows *= 10)
+    {
+        io_schema_cases<2>(runner, rows);
+        io_schema_cases<8>(runner, rows);
+        io_schema_cases<32>(runner, rows);
+    }
+
+    runner.report();
+    return 0;
+}
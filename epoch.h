@@ -0,0 +1,195 @@
+#ifndef MSH_EPOCH_H
+#define MSH_EPOCH_H
+
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#ifndef LOG
+#define LOG(x) std::cout << x << std::endl
+#endif
+#ifndef Print
+#define Print(x) std::cout << x << ' '
+#endif
+
+namespace msh
+{
+    // ----------------------------->     EPOCH_DOMAIN     <-----------------------------
+
+    // Epoch-based reclamation. Readers enter the domain (through epoch_guard)
+    // before loading a published pointer and leave it when they are done with
+    // it. Writers retire the blocks they replace, and a retired block is freed
+    // only once every reader that was inside the domain at the time has left.
+    class epoch_domain
+    {
+    // ------------------->     Variables     <-------------------
+    public:
+        static const size_t max_readers = 128;
+    private:
+        struct retired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+            uint64_t epoch;
+        };
+
+        // One cache line per slot, so readers entering and leaving do not
+        // invalidate each other's lines
+        struct alignas(64) reader_slot
+        {
+            // Epoch the reader entered at, 0 for a free slot
+            std::atomic<uint64_t> epoch;
+        };
+
+        alignas(64) std::atomic<uint64_t> global_epoch{1};
+        reader_slot slots[max_readers];
+        std::mutex retire_mutex;
+        std::vector<retired> retired_list;
+
+    // ------------------->      Methods      <-------------------
+    public:
+        // -----> Constructors and Destructor <-----
+        // Default Constructor
+        epoch_domain();
+        epoch_domain(const epoch_domain &) = delete;
+        epoch_domain &operator=(const epoch_domain &) = delete;
+        // Destructor
+        ~epoch_domain();
+
+        // -----> Getters <-----
+        // Number of retired blocks not freed yet
+        size_t pending();
+        // Domain used when none is given
+        static epoch_domain &global();
+
+        // -----> Other Methods <-----
+        // Occupy a reader slot, returns its index
+        size_t enter();
+        // Free a reader slot
+        void exit(size_t);
+        // Hand over a replaced block, freed once no reader can still see it
+        void retire(void *, void (*)(void *));
+        // Free the retired blocks no reader can see anymore, returns how many
+        size_t reclaim();
+    };
+
+    // ----------------------------->     EPOCH_GUARD     <-----------------------------
+
+    // Keeps the calling thread inside a domain for the lifetime of the guard
+    class epoch_guard
+    {
+    private:
+        epoch_domain &domain;
+        size_t slot;
+    public:
+        explicit epoch_guard(epoch_domain &domain = epoch_domain::global()) : domain(domain), slot(domain.enter()) {}
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard &operator=(const epoch_guard &) = delete;
+        ~epoch_guard() { domain.exit(slot); }
+    };
+
+    // -----> Constructors and Destructor <-----
+    // Default Constructor
+    inline epoch_domain::epoch_domain()
+    {
+        for (size_t i = 0; i < max_readers; ++i)
+            slots[i].epoch.store(0);
+    }
+    // Destructor
+    inline epoch_domain::~epoch_domain()
+    {
+        for (retired &block : retired_list)
+            block.deleter(block.ptr);
+    }
+
+    // -----> Getters <-----
+    // Number of retired blocks not freed yet
+    inline size_t epoch_domain::pending()
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        return retired_list.size();
+    }
+    // Domain used when none is given
+    inline epoch_domain &epoch_domain::global()
+    {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    // -----> Other Methods <-----
+    // Occupy a reader slot, returns its index
+    inline size_t epoch_domain::enter()
+    {
+        size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % max_readers;
+        for (;;)
+        {
+            uint64_t epoch = global_epoch.load();
+            for (size_t n = 0; n < max_readers; ++n)
+            {
+                size_t i = (start + n) % max_readers;
+                uint64_t expected = 0;
+                if (slots[i].epoch.compare_exchange_strong(expected, epoch))
+                {
+                    // A writer that advanced the epoch before the slot was
+                    // visible may not have seen it: announce the newer epoch
+                    while (global_epoch.load() != epoch)
+                    {
+                        epoch = global_epoch.load();
+                        slots[i].epoch.store(epoch);
+                    }
+                    return i;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+    // Free a reader slot
+    inline void epoch_domain::exit(size_t slot)
+    {
+        slots[slot].epoch.store(0, std::memory_order_release);
+    }
+    // Hand over a replaced block, freed once no reader can still see it
+    inline void epoch_domain::retire(void *ptr, void (*deleter)(void *))
+    {
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex);
+            retired_list.push_back({ptr, deleter, global_epoch.fetch_add(1)});
+        }
+        reclaim();
+    }
+    // Free the retired blocks no reader can see anymore, returns how many
+    inline size_t epoch_domain::reclaim()
+    {
+        // Blocks retired after this point are left for the next call
+        uint64_t oldest = global_epoch.load();
+        for (size_t i = 0; i < max_readers; ++i)
+        {
+            uint64_t epoch = slots[i].epoch.load();
+            if (epoch != 0 && epoch < oldest)
+                oldest = epoch;
+        }
+
+        std::vector<retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex);
+            size_t kept = 0;
+            for (size_t i = 0; i < retired_list.size(); ++i)
+            {
+                if (retired_list[i].epoch < oldest)
+                    ready.push_back(retired_list[i]);
+                else
+                    retired_list[kept++] = retired_list[i];
+            }
+            retired_list.resize(kept);
+        }
+
+        for (retired &block : ready)
+            block.deleter(block.ptr);
+        return ready.size();
+    }
+} // namespace msh
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef MSH_INSTRUMENT_H
+#define MSH_INSTRUMENT_H
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#include <cstdlib>
+#include <cxxabi.h>
+
+#ifndef LOG
+#define LOG(x) std::cout << x << std::endl
+#endif
+#ifndef Print
+#define Print(x) std::cout << x << ' '
+#endif
+
+// Define MSH_INSTRUMENT before including the containers to count their
+// allocations and copies. Without it the hooks compile to nothing and the
+// counters below always read zero.
+#ifdef MSH_INSTRUMENT
+#define MSH_COUNT_ALLOCATE(type, bytes) msh::instrument::on_allocate<type>(bytes)
+#define MSH_COUNT_DEALLOCATE(type, bytes) msh::instrument::on_deallocate<type>(bytes)
+#define MSH_COUNT_REALLOCATE(type) msh::instrument::on_reallocate<type>()
+#define MSH_COUNT_COPY(type, bytes) msh::instrument::on_copy<type>(bytes)
+#else
+#define MSH_COUNT_ALLOCATE(type, bytes) ((void)0)
+#define MSH_COUNT_DEALLOCATE(type, bytes) ((void)0)
+#define MSH_COUNT_REALLOCATE(type) ((void)0)
+#define MSH_COUNT_COPY(type, bytes) ((void)0)
+#endif
+
+namespace msh
+{
+namespace instrument
+{
+    // ----------------------------->     ALLOC_STATS     <-----------------------------
+
+    // Snapshot of the counters
+    struct alloc_stats
+    {
+        size_t allocations;
+        size_t deallocations;
+        size_t reallocations;
+        size_t bytes_allocated;
+        size_t bytes_copied;
+        size_t live_bytes;
+        size_t peak_live_bytes;
+    };
+
+    // ----------------------------->     ALLOC_COUNTER     <-----------------------------
+
+    class alloc_counter
+    {
+    // ------------------->     Variables     <-------------------
+    private:
+        std::string _name;
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> deallocations{0};
+        std::atomic<size_t> reallocations{0};
+        std::atomic<size_t> bytes_allocated{0};
+        std::atomic<size_t> bytes_copied{0};
+        std::atomic<size_t> live_bytes{0};
+        std::atomic<size_t> peak_live_bytes{0};
+
+    // ------------------->      Methods      <-------------------
+    public:
+        explicit alloc_counter(const std::string &name) : _name(name) {}
+
+        // -----> Getters <-----
+        const std::string &name() const { return _name; }
+        alloc_stats stats() const;
+
+        // -----> Other Methods <-----
+        void allocate(size_t);
+        void deallocate(size_t);
+        void reallocate();
+        void copy(size_t);
+        // Zero the event counters. Live bytes are kept, since the blocks are
+        // still alive, and the peak restarts from them.
+        void reset();
+    };
+
+    // -----> Getters <-----
+    inline alloc_stats alloc_counter::stats() const
+    {
+        return {allocations.load(), deallocations.load(), reallocations.load(), bytes_allocated.load(),
+                bytes_copied.load(), live_bytes.load(), peak_live_bytes.load()};
+    }
+
+    // -----> Other Methods <-----
+    inline void alloc_counter::allocate(size_t bytes)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        size_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+    }
+    inline void alloc_counter::deallocate(size_t bytes)
+    {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+    inline void alloc_counter::reallocate()
+    {
+        reallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void alloc_counter::copy(size_t bytes)
+    {
+        bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    inline void alloc_counter::reset()
+    {
+        allocations.store(0);
+        deallocations.store(0);
+        reallocations.store(0);
+        bytes_allocated.store(0);
+        bytes_copied.store(0);
+        peak_live_bytes.store(live_bytes.load());
+    }
+
+    // ----------------------------->     REGISTRY     <-----------------------------
+
+    // Every per-type counter created so far, in order of first use
+    class registry
+    {
+    private:
+        std::mutex mutex;
+        std::vector<std::unique_ptr<alloc_counter>> counters;
+    public:
+        alloc_counter &add(const std::string &name)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.emplace_back(new alloc_counter(name));
+            return *counters.back();
+        }
+        template <typename F>
+        void for_each(F fn)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const std::unique_ptr<alloc_counter> &counter : counters)
+                fn(*counter);
+        }
+        static registry &instance()
+        {
+            static registry types;
+            return types;
+        }
+    };
+
+    // Readable name of a type
+    template <typename T>
+    std::string type_name()
+    {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+        std::string name = (status == 0 && demangled ? demangled : typeid(T).name());
+        std::free(demangled);
+        return name;
+    }
+
+    // Counter of all the containers together
+    inline alloc_counter &global()
+    {
+        static alloc_counter total("total");
+        return total;
+    }
+    // Counter of one container type, e.g. counter<msh::vector<double>>()
+    template <typename C>
+    alloc_counter &counter()
+    {
+        static alloc_counter &type = registry::instance().add(type_name<C>());
+        return type;
+    }
+
+    // -----> Hooks <-----
+    template <typename C>
+    inline void on_allocate(size_t bytes)
+    {
+        global().allocate(bytes);
+        counter<C>().allocate(bytes);
+    }
+    template <typename C>
+    inline void on_deallocate(size_t bytes)
+    {
+        global().deallocate(bytes);
+        counter<C>().deallocate(bytes);
+    }
+    template <typename C>
+    inline void on_reallocate()
+    {
+        global().reallocate();
+        counter<C>().reallocate();
+    }
+    template <typename C>
+    inline void on_copy(size_t bytes)
+    {
+        global().copy(bytes);
+        counter<C>().copy(bytes);
+    }
+
+    // -----> Queries <-----
+    // Counters of all the containers together
+    inline alloc_stats stats()
+    {
+        return global().stats();
+    }
+    // Counters of one container type
+    template <typename C>
+    alloc_stats stats()
+    {
+        return counter<C>().stats();
+    }
+    // Zero the event counters of the total and of every container type, keeping the live bytes
+    inline void reset()
+    {
+        global().reset();
+        registry::instance().for_each([](alloc_counter &type) { type.reset(); });
+    }
+    // Print one line for the total and one per container type
+    inline void report(std::ostream &os = std::cout)
+    {
+        auto line = [&os](const alloc_counter &counter)
+        {
+            alloc_stats s = counter.stats();
+            os << std::left << std::setw(40) << counter.name() << std::right
+               << std::setw(10) << s.allocations << std::setw(10) << s.deallocations
+               << std::setw(10) << s.reallocations << std::setw(16) << s.bytes_allocated
+               << std::setw(16) << s.bytes_copied << std::setw(16) << s.live_bytes
+               << std::setw(16) << s.peak_live_bytes << '\n';
+        };
+
+        os << std::left << std::setw(40) << "type" << std::right
+           << std::setw(10) << "allocs" << std::setw(10) << "frees" << std::setw(10) << "reallocs"
+           << std::setw(16) << "bytes_alloc" << std::setw(16) << "bytes_copied"
+           << std::setw(16) << "live_bytes" << std::setw(16) << "peak_bytes" << '\n';
+        registry::instance().for_each(line);
+        line(global());
+    }
+} // namespace instrument
+} // namespace msh
+
+#endif
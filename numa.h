@@ -0,0 +1,263 @@
+#ifndef MSH_NUMA_H
+#define MSH_NUMA_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef LOG
+#define LOG(x) std::cout << x << std::endl
+#endif
+#ifndef Print
+#define Print(x) std::cout << x << ' '
+#endif
+
+namespace msh
+{
+namespace numa
+{
+    // Memory policy modes and flags of mbind(2), as in <numaif.h>
+    const int mpol_bind = 2;
+    const int mpol_interleave = 3;
+    const unsigned mpol_mf_move = 1u << 1;
+
+    // Where the pages of a new block should land
+    enum class placement
+    {
+        // Wherever the thread that writes them first runs
+        none,
+        // Zeroed in parallel, one partition per thread, threads spread over the nodes
+        first_touch,
+        // Pages spread round-robin over all nodes
+        interleave,
+        // One contiguous partition per node, in node order
+        partitioned
+    };
+
+    // -----> Topology <-----
+    // Expand a kernel list such as "0-3,8,10-11"
+    inline std::vector<int> parse_list(const std::string &list)
+    {
+        std::vector<int> values;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ','))
+        {
+            if (range.empty() || range == "\n")
+                continue;
+            size_t dash = range.find('-');
+            int first = std::atoi(range.c_str());
+            int last = (dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1));
+            for (int value = first; value <= last; ++value)
+                values.push_back(value);
+        }
+        return values;
+    }
+    // Read a one-line list from sysfs, empty if it does not exist
+    inline std::vector<int> read_list(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        if (!file.is_open() || !std::getline(file, line))
+            return {};
+        return parse_list(line);
+    }
+    // Online memory nodes, just node 0 when the kernel does not report any
+    inline const std::vector<int> &nodes()
+    {
+        static const std::vector<int> online = []()
+        {
+            std::vector<int> list = read_list("/sys/devices/system/node/online");
+            return (list.empty() ? std::vector<int>{0} : list);
+        }();
+        return online;
+    }
+    // Number of online memory nodes
+    inline size_t node_count()
+    {
+        return nodes().size();
+    }
+    // CPUs of a node
+    inline std::vector<int> node_cpus(int node)
+    {
+        return read_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    }
+
+    // -----> Memory Policy <-----
+    // Apply a memory policy to the whole pages inside a range, false if the kernel refused.
+    // Pages already faulted in, e.g. heap pages recycled by new[], are moved as well.
+    inline bool bind(void *ptr, size_t bytes, int mode, const std::vector<int> &to)
+    {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+        uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes) / page * page;
+        if (end <= begin)
+            return true;
+
+        const size_t bits = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask(1024 / bits, 0);
+        for (int node : to)
+            if (node >= 0 && static_cast<size_t>(node) < 1024)
+                mask[node / bits] |= 1ul << (node % bits);
+
+        return syscall(SYS_mbind, begin, end - begin, mode, mask.data(), 1024 + 1, mpol_mf_move) == 0;
+    }
+
+    // Zero a range in parallel. With pin set, thread i runs on the CPUs of
+    // node i * nodes / threads, so first touch spreads the pages over the nodes.
+    inline void touch(void *ptr, size_t bytes, size_t threads, bool pin)
+    {
+        if (threads == 0)
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t pages = (bytes + page - 1) / page;
+        if (threads > pages)
+            threads = std::max<size_t>(1, pages);
+
+        char *base = static_cast<char *>(ptr);
+        auto worker = [=](size_t i)
+        {
+            if (pin)
+            {
+                std::vector<int> cpus = node_cpus(nodes()[i * node_count() / threads]);
+                if (!cpus.empty())
+                {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    for (int cpu : cpus)
+                        CPU_SET(cpu, &set);
+                    sched_setaffinity(0, sizeof(set), &set);
+                }
+            }
+            size_t begin = std::min(bytes, pages * i / threads * page);
+            size_t end = std::min(bytes, pages * (i + 1) / threads * page);
+            std::memset(base + begin, 0, end - begin);
+        };
+
+        if (threads == 1)
+        {
+            std::memset(base, 0, bytes);
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (size_t i = 0; i < threads; ++i)
+            pool.emplace_back(worker, i);
+        for (std::thread &thread : pool)
+            thread.join();
+    }
+
+    // Give the whole pages inside a range back to the kernel, so the next
+    // write faults them in again wherever the writing thread runs
+    inline void release_pages(void *ptr, size_t bytes)
+    {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+        uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes) / page * page;
+        if (end > begin)
+            madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+    }
+
+    // Place a freshly allocated block that no thread has written yet. On a
+    // single node, or when the kernel refuses a policy, the block is still
+    // zeroed in parallel and ends up on the local node.
+    inline void place(void *ptr, size_t bytes, placement policy, size_t threads = 0, bool zero = true)
+    {
+        bool multi_node = node_count() > 1;
+
+        switch (policy)
+        {
+        case placement::none:
+            return;
+        case placement::first_touch:
+            // A block below the mmap threshold of malloc may reuse heap
+            // pages that are already faulted in, and touching those again
+            // would not move them
+            if (multi_node && zero)
+                release_pages(ptr, bytes);
+            break;
+        case placement::interleave:
+            if (multi_node)
+                bind(ptr, bytes, mpol_interleave, nodes());
+            break;
+        case placement::partitioned:
+            if (multi_node)
+            {
+                size_t count = node_count();
+                char *base = static_cast<char *>(ptr);
+                for (size_t i = 0; i < count; ++i)
+                    bind(base + bytes * i / count, bytes * (i + 1) / count - bytes * i / count, mpol_bind, {nodes()[i]});
+            }
+            break;
+        }
+        if (zero)
+            touch(ptr, bytes, threads, multi_node && policy == placement::first_touch);
+    }
+
+    // Place an array of count elements. Only types that may be zeroed bytewise
+    // are touched; others were already written by their constructors.
+    template <typename T>
+    void place(T *ptr, size_t count, placement policy, size_t threads = 0)
+    {
+        place(static_cast<void *>(ptr), count * sizeof(T), policy, threads,
+              std::is_trivially_default_constructible<T>::value && std::is_trivially_copyable<T>::value);
+    }
+
+    // -----> Inspection <-----
+    // Resident pages per node of every mapping that overlaps the range, read
+    // from /proc/self/maps and /proc/self/numa_maps. Index i is node i.
+    inline std::vector<size_t> resident_pages(const void *ptr, size_t bytes)
+    {
+        uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+        uintptr_t end = begin + bytes;
+        std::vector<uintptr_t> starts;
+
+        std::ifstream maps("/proc/self/maps");
+        std::string line;
+        while (std::getline(maps, line))
+        {
+            uintptr_t first = std::strtoull(line.c_str(), nullptr, 16);
+            uintptr_t last = std::strtoull(line.c_str() + line.find('-') + 1, nullptr, 16);
+            if (first < end && last > begin)
+                starts.push_back(first);
+        }
+
+        std::vector<size_t> pages;
+        std::ifstream numa_maps("/proc/self/numa_maps");
+        while (std::getline(numa_maps, line))
+        {
+            uintptr_t first = std::strtoull(line.c_str(), nullptr, 16);
+            bool overlaps = false;
+            for (uintptr_t start : starts)
+                overlaps = overlaps || start == first;
+            if (!overlaps)
+                continue;
+
+            std::stringstream fields(line);
+            std::string field;
+            while (fields >> field)
+            {
+                if (field.size() < 3 || field[0] != 'N' || field.find('=') == std::string::npos)
+                    continue;
+                size_t node = std::strtoul(field.c_str() + 1, nullptr, 10);
+                if (pages.size() <= node)
+                    pages.resize(node + 1, 0);
+                pages[node] += std::strtoul(field.c_str() + field.find('=') + 1, nullptr, 10);
+            }
+        }
+        return pages;
+    }
+} // namespace numa
+} // namespace msh
+
+#endif
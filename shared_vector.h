@@ -3,6 +3,20 @@
 
 #include <iostream>
 #include <cstring>
+#include <string>
+#include <atomic>
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "epoch.h"
+#include "instrument.h"
+#include "numa.h"
 
 #ifndef LOG
 #define LOG(x) std::cout << x << std::endl
@@ -19,6 +33,73 @@ namespace msh
     template <typename T>
     class array;
 
+    template <typename T>
+    class shared_view;
+
+    // ----------------------------->     GROWTH_POLICY     <-----------------------------
+
+    // How much the capacity grows when the array runs out of room by itself
+    // (emplace_back or operator[] past the end). The new capacity is
+    // capacity * numerator / denominator, e.g. 2/1 for 2x or 3/2 for 1.5x,
+    // optionally rounded up so the block in bytes is a multiple of round_to.
+    struct growth_policy
+    {
+        size_t numerator;
+        size_t denominator;
+        size_t round_to;
+
+        growth_policy(size_t numerator = 2, size_t denominator = 1, size_t round_to = 0)
+            : numerator(numerator), denominator(denominator), round_to(round_to) {}
+
+        // Size of a memory page, to be used as round_to
+        static size_t page_size()
+        {
+            long page = sysconf(_SC_PAGESIZE);
+            return (page > 0 ? static_cast<size_t>(page) : 4096);
+        }
+    };
+
+    // ----------------------------->     SEGMENT     <-----------------------------
+
+    // Control block at the start of a mapped segment, either a named POSIX
+    // shared-memory object or a file. The elements follow it, starting at
+    // the next page boundary.
+    struct segment_header
+    {
+        static const uint64_t magic_number = 0x314d47455348534d; // "MSHSEGM1"
+
+        uint64_t magic;
+        // Number of processes that have the segment mapped
+        std::atomic<size_t> attached;
+        // Set by the loader once the elements can be read
+        std::atomic<bool> published;
+        // Frozen once published, so other processes read it without a lock
+        size_t size;
+        size_t capacity;
+        size_t element_size;
+    };
+
+    // Mapping of a segment in this process, shared by all of its handles
+    struct segment_mapping
+    {
+        segment_header *header;
+        void *data;
+        size_t data_bytes;
+        // Kept open for files so they can grow, -1 for shared memory
+        int fd;
+    };
+
+    // ----------------------------->     EPOCH_STATE     <-----------------------------
+
+    // Array and size that readers see when reallocation is epoch-protected
+    template <typename T>
+    struct epoch_state
+    {
+        epoch_domain *domain;
+        std::atomic<T *> array;
+        std::atomic<size_t> size;
+    };
+
     // ----------------------------->     SHARED_VECTOR     <-----------------------------
 
     template <typename T>
@@ -26,12 +107,16 @@ namespace msh
     {
         // ------------------->     Variables     <-------------------
     private:
+        // Heap array, unused by mapped vectors whose elements are at _mapping->data
         T *_array;
         T *temp_array;
         size_t *_count;
         size_t *_size;
         size_t *_capacity;
         bool *allowIndexOutOfBound{new bool(false)};
+        growth_policy *_growth{nullptr};
+        segment_mapping *_mapping{nullptr};
+        epoch_state<T> *_epoch{nullptr};
 
         // ------------------->      Methods      <-------------------
     public:
@@ -48,6 +133,37 @@ namespace msh
         // Destructor
         ~shared_vector();
 
+        // -----> Shared Memory <-----
+        // Create a named shared-memory segment with a fixed capacity (loader side)
+        static shared_vector create_shared(const std::string &, size_t);
+        // Attach read-only to a published segment, empty if it is not published yet
+        static shared_view<T> attach_shared(const std::string &);
+        // Remove the name of a segment, mappings stay valid until released
+        static void unlink_shared(const std::string &);
+        // Make the elements written so far visible to attach_shared(), nothing can be appended after it
+        void publish();
+        // Whether the array lives in a mapped segment (shared memory or file)
+        bool is_shared() const;
+        // Number of processes that have the segment mapped
+        size_t attach_count() const;
+
+        // -----> File Backed <-----
+        // Create a vector stored in a file, or in an unnamed temporary file if the path is empty
+        static shared_vector create_mapped(const std::string &, size_t);
+        // Reopen a vector persisted by create_mapped()
+        static shared_vector open_mapped(const std::string &);
+        // Write the elements and the size to the file
+        void flush();
+        // Whether the array lives in a file that grows with it
+        bool is_file_backed() const;
+
+        // -----> Epoch Reclamation <-----
+        // Retire replaced arrays through the domain instead of deleting them,
+        // only while this is the sole handle of the array
+        void enable_epochs(epoch_domain &domain = epoch_domain::global());
+        // Whether replaced arrays are retired through an epoch domain
+        bool is_epoch_protected() const;
+
         // -----> Getters <-----
         // Get array
         T *get_array() const;
@@ -59,10 +175,14 @@ namespace msh
         size_t capacity() const;
         // Get permission situation whether to add new element to the array or not
         bool get_permission() const;
+        // Get growth policy
+        const growth_policy &get_growth() const;
 
         // -----> Setters <-----
         // To change permission to add new element to the array
         void set_permission(bool);
+        // To change how the capacity grows when the array is full
+        void set_growth(const growth_policy &);
         // To add one count to the object to have the object for one more upper scope
         void add_count();
 
@@ -85,6 +205,8 @@ namespace msh
         // -----> Other Methods <-----
         // Reserve some amount of blocks
         void reserve(size_t);
+        // Reserve some amount of blocks whose pages are placed over the NUMA nodes
+        void reserve(size_t, numa::placement, size_t threads = 0);
         // Shrink capacity to size
         void shrink();
         void shrink(size_t);
@@ -94,8 +216,26 @@ namespace msh
     private:
         // Release the shared object and decrement the reference count
         void release();
+        // Stop before appending to a published segment
+        void check_appendable() const;
+        // How map_segment() opens a segment
+        enum class segment_open { create, attach, reopen };
+        // Map the segment behind the file descriptor into this handle
+        bool map_segment(int, segment_open, bool, size_t);
+        // Resize a file-backed segment
+        void remap(size_t);
+        // Unmap the segment and leave it to the other processes
+        void detach();
+        // Segment name with the leading slash required by shm_open
+        static std::string shm_name(const std::string &);
+        // Array readers should use, the published one in epoch mode
+        T *data() const;
+        // Make the current size visible to epoch-protected readers
+        void publish_size();
         // Reallocate the array
         void realloc(size_t _capacity = 0);
+        // Next capacity according to the growth policy
+        size_t grown_capacity() const;
         // Swap the temperory array to _array
         void swap();
     };
@@ -105,13 +245,20 @@ namespace msh
     shared_vector<T>::shared_vector() : _array(nullptr), _count(nullptr), _size(nullptr), _capacity(nullptr) {}
 
     template <typename T>
-    shared_vector<T>::shared_vector(size_t count) : _array(new T[count]), _count(new size_t(1)), _size(new size_t(0)), _capacity(new size_t(count)) {}
+    shared_vector<T>::shared_vector(size_t count) : _array(new T[count]), _count(new size_t(1)), _size(new size_t(0)), _capacity(new size_t(count)), _growth(new growth_policy())
+    {
+        MSH_COUNT_ALLOCATE(shared_vector<T>, count * sizeof(T));
+    }
 
     template <typename T>
-    shared_vector<T>::shared_vector(T *ptr) : _array(ptr), _count(new size_t(1)), _size(new size_t(0)), _capacity(new size_t(1)) {}
+    shared_vector<T>::shared_vector(T *ptr) : _array(ptr), _count(new size_t(1)), _size(new size_t(0)), _capacity(new size_t(1)), _growth(new growth_policy())
+    {
+        // Adopted, but released like any other block
+        MSH_COUNT_ALLOCATE(shared_vector<T>, sizeof(T));
+    }
 
     template <typename T>
-    shared_vector<T>::shared_vector(const shared_vector &other) : _array(other._array), _count(other._count), _size(other._size), _capacity(other._capacity), allowIndexOutOfBound(other.allowIndexOutOfBound)
+    shared_vector<T>::shared_vector(const shared_vector &other) : _array(other._array), _count(other._count), _size(other._size), _capacity(other._capacity), allowIndexOutOfBound(other.allowIndexOutOfBound), _growth(other._growth), _mapping(other._mapping), _epoch(other._epoch)
     {
         if (_count)
             ++(*_count);
@@ -125,12 +272,198 @@ namespace msh
         release();
     }
 
+    // -----> Shared Memory <-----
+    // Create a named shared-memory segment with a fixed capacity (loader side)
+    template <typename T>
+    shared_vector<T> shared_vector<T>::create_shared(const std::string &name, size_t capacity)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "shared memory needs a trivially copyable type");
+
+        int fd = shm_open(shm_name(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1)
+        {
+            LOG("Failed to create shared memory " << name << "\nProgram terminated");
+            exit(1);
+        }
+        if (ftruncate(fd, growth_policy::page_size() + capacity * sizeof(T)) == -1)
+        {
+            close(fd);
+            shm_unlink(shm_name(name).c_str());
+            LOG("Failed to size shared memory " << name << "\nProgram terminated");
+            exit(1);
+        }
+
+        shared_vector result;
+        if (!result.map_segment(fd, segment_open::create, false, capacity))
+        {
+            shm_unlink(shm_name(name).c_str());
+            LOG("Failed to map shared memory " << name << "\nProgram terminated");
+            exit(1);
+        }
+        return result;
+    }
+
+    // Attach read-only to a published segment, empty if it is not published yet.
+    // The pages are mapped read-only, so the handle only gives const access.
+    template <typename T>
+    shared_view<T> shared_vector<T>::attach_shared(const std::string &name)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "shared memory needs a trivially copyable type");
+
+        shared_vector result;
+        int fd = shm_open(shm_name(name).c_str(), O_RDWR, 0);
+        if (fd != -1)
+            result.map_segment(fd, segment_open::attach, false, 0);
+        return shared_view<T>(result);
+    }
+
+    // Remove the name of a segment, mappings stay valid until released
+    template <typename T>
+    void shared_vector<T>::unlink_shared(const std::string &name)
+    {
+        shm_unlink(shm_name(name).c_str());
+    }
+
+    // Make the elements written so far visible to attach_shared(). The size is
+    // frozen from then on, so readers in other processes never race with the loader.
+    template <typename T>
+    void shared_vector<T>::publish()
+    {
+        if (_mapping)
+            _mapping->header->published.store(true, std::memory_order_release);
+    }
+
+    // Whether the array lives in a mapped segment (shared memory or file)
+    template <typename T>
+    bool shared_vector<T>::is_shared() const
+    {
+        return _mapping != nullptr;
+    }
+
+    // Number of processes that have the segment mapped
+    template <typename T>
+    size_t shared_vector<T>::attach_count() const
+    {
+        return (_mapping ? _mapping->header->attached.load() : 0);
+    }
+
+    // -----> File Backed <-----
+    // Create a vector stored in a file, or in an unnamed temporary file if the
+    // path is empty. The file grows with the vector through ftruncate and
+    // mremap instead of new[] and a copy, so it can exceed physical memory.
+    template <typename T>
+    shared_vector<T> shared_vector<T>::create_mapped(const std::string &path, size_t capacity)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "file-backed storage needs a trivially copyable type");
+
+        int fd;
+        if (path.empty())
+        {
+            const char *dir = std::getenv("TMPDIR");
+            std::string name = std::string(dir && *dir ? dir : "/tmp") + "/msh_vector_XXXXXX";
+            fd = mkstemp(&name[0]);
+            if (fd != -1)
+                unlink(name.c_str());
+        }
+        else
+            fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (fd == -1)
+        {
+            LOG("Failed to create " << (path.empty() ? "temporary file" : path) << "\nProgram terminated");
+            exit(1);
+        }
+        if (ftruncate(fd, growth_policy::page_size() + capacity * sizeof(T)) == -1)
+        {
+            close(fd);
+            LOG("Failed to size " << path << "\nProgram terminated");
+            exit(1);
+        }
+
+        shared_vector result;
+        if (!result.map_segment(fd, segment_open::create, true, capacity))
+        {
+            LOG("Failed to map " << path << "\nProgram terminated");
+            exit(1);
+        }
+        return result;
+    }
+
+    // Reopen a vector persisted by create_mapped()
+    template <typename T>
+    shared_vector<T> shared_vector<T>::open_mapped(const std::string &path)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "file-backed storage needs a trivially copyable type");
+
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd == -1)
+        {
+            LOG("Failed to open " << path << "\nProgram terminated");
+            exit(1);
+        }
+
+        shared_vector result;
+        if (!result.map_segment(fd, segment_open::reopen, true, 0))
+        {
+            LOG(path << " does not hold a complete vector of this type\nProgram terminated");
+            exit(1);
+        }
+        return result;
+    }
+
+    // Write the elements and the size to the file
+    template <typename T>
+    void shared_vector<T>::flush()
+    {
+        if (_mapping)
+        {
+            if (_mapping->data)
+                msync(_mapping->data, _mapping->data_bytes, MS_SYNC);
+            msync(_mapping->header, growth_policy::page_size(), MS_SYNC);
+        }
+    }
+
+    // Whether the array lives in a file that grows with it
+    template <typename T>
+    bool shared_vector<T>::is_file_backed() const
+    {
+        return _mapping && _mapping->fd != -1;
+    }
+
+    // -----> Epoch Reclamation <-----
+    // Retire replaced arrays through the domain instead of deleting them.
+    // Readers hold an epoch_guard while they use the pointer from get() and
+    // read size() before get(). Only one handle may write at a time, and
+    // only growing is safe while readers are inside the domain. Other
+    // handles would keep the unprotected array, so this must be the only one.
+    template <typename T>
+    void shared_vector<T>::enable_epochs(epoch_domain &domain)
+    {
+        // Segments are never reallocated
+        if (_mapping || _epoch)
+            return;
+        if (_count && *_count > 1)
+        {
+            LOG("Enable epochs before copying the vector to other handles\nProgram terminated");
+            exit(1);
+        }
+        if (!_count)
+            realloc(1);
+        _epoch = new epoch_state<T>{&domain, _array, *_size};
+    }
+
+    // Whether replaced arrays are retired through an epoch domain
+    template <typename T>
+    bool shared_vector<T>::is_epoch_protected() const
+    {
+        return _epoch != nullptr;
+    }
+
     // -----> Getters <-----
     // Get array
     template <typename T>
     T *shared_vector<T>::get_array() const
     {
-        return _array;
+        return data();
     }
 
     // Get count
@@ -145,6 +478,8 @@ namespace msh
     template <typename T>
     size_t shared_vector<T>::size() const
     {
+        if (_epoch)
+            return _epoch->size.load(std::memory_order_acquire);
         return (_size ? *_size : 0);
     }
 
@@ -162,6 +497,14 @@ namespace msh
         return *allowIndexOutOfBound;
     }
 
+    // Get growth policy
+    template <typename T>
+    const growth_policy &shared_vector<T>::get_growth() const
+    {
+        static const growth_policy fallback;
+        return (_growth ? *_growth : fallback);
+    }
+
     // -----> Setters <-----
     // To change permission to add new element to the array
     template <typename T>
@@ -170,6 +513,20 @@ namespace msh
         *allowIndexOutOfBound = flag;
     }
 
+    // To change how the capacity grows when the array is full
+    template <typename T>
+    void shared_vector<T>::set_growth(const growth_policy &policy)
+    {
+        if (policy.numerator <= policy.denominator || policy.denominator == 0)
+        {
+            LOG("Growth factor must be greater than one\nProgram terminated");
+            exit(1);
+        }
+        if (!_count)
+            realloc(1);
+        *_growth = policy;
+    }
+
     // To add one count to the object to have the object for one more upper scope
     template <typename T>
     void shared_vector<T>::add_count()
@@ -194,7 +551,7 @@ namespace msh
     template <typename T>
     shared_vector<T> &shared_vector<T>::operator=(const shared_vector &other)
     {
-        if (this != &other)
+        if (this != std::addressof(other))
         {
             release();
             _array = other._array;
@@ -202,6 +559,9 @@ namespace msh
             _size = other._size;
             _capacity = other._capacity;
             allowIndexOutOfBound = other.allowIndexOutOfBound;
+            _growth = other._growth;
+            _mapping = other._mapping;
+            _epoch = other._epoch;
             if (_count)
                 ++(*_count);
         }
@@ -223,7 +583,7 @@ namespace msh
 
         if (index < *_size)
         {
-            return _array[index];
+            return data()[index];
         }
         else if (*allowIndexOutOfBound)
         {
@@ -234,10 +594,12 @@ namespace msh
             }
             else
             {
-                ++(*_size);
-                if (*_size > *_capacity)
+                check_appendable();
+                if (*_size >= *_capacity)
                     realloc();
-                return _array[index];
+                ++(*_size);
+                publish_size();
+                return data()[index];
             }
         }
         else
@@ -251,28 +613,28 @@ namespace msh
     template <typename T>
     T *shared_vector<T>::operator&() const
     {
-        return _array;
+        return data();
     }
 
     // Dereference operator
     template <typename T>
     T &shared_vector<T>::operator*() const
     {
-        return *_array;
+        return *data();
     }
 
     // Arrow operator
     template <typename T>
     T *shared_vector<T>::operator->() const
     {
-        return _array;
+        return data();
     }
 
     // Get the pointer to the underlying object
     template <typename T>
     T *shared_vector<T>::get() const
     {
-        return _array;
+        return data();
     }
 
     // -----> Other Methods <-----
@@ -283,16 +645,60 @@ namespace msh
         realloc(_capacity);
     }
 
+    // Reserve some amount of blocks whose pages are placed over the NUMA nodes.
+    // The new block is placed before the current elements are copied into it.
+    // Mapped segments keep the placement of the page cache.
+    template <typename T>
+    void shared_vector<T>::reserve(size_t _capacity, numa::placement policy, size_t threads)
+    {
+        if (_mapping)
+        {
+            realloc(_capacity);
+            return;
+        }
+
+        if (!_count)
+        {
+            // Only the control block, the array is the placed one below
+            this->_array = nullptr;
+            this->_count = new size_t(1);
+            this->_size = new size_t(0);
+            this->_capacity = new size_t(0);
+            this->_growth = new growth_policy();
+        }
+        else
+        {
+            MSH_COUNT_REALLOCATE(shared_vector<T>);
+            MSH_COUNT_DEALLOCATE(shared_vector<T>, *(this->_capacity) * sizeof(T));
+        }
+        if (*(this->_size) > _capacity)
+            *(this->_size) = _capacity;
+        *(this->_capacity) = _capacity;
+
+        MSH_COUNT_ALLOCATE(shared_vector<T>, _capacity * sizeof(T));
+        MSH_COUNT_COPY(shared_vector<T>, *(this->_size) * sizeof(T));
+        temp_array = new T[_capacity];
+        numa::place(temp_array, _capacity, policy, threads);
+        if (*(this->_size) > 0)
+            std::memcpy(temp_array, data(), *(this->_size) * sizeof(T));
+        swap();
+        publish_size();
+    }
+
     // Shrink capacity to size
     template <typename T>
     void shared_vector<T>::shrink()
     {
-        if (_count)
+        if (_count && !_mapping)
             if (*_capacity > *_size)
             {
+                MSH_COUNT_REALLOCATE(shared_vector<T>);
+                MSH_COUNT_DEALLOCATE(shared_vector<T>, *_capacity * sizeof(T));
+                MSH_COUNT_ALLOCATE(shared_vector<T>, *_size * sizeof(T));
+                MSH_COUNT_COPY(shared_vector<T>, *_size * sizeof(T));
                 *_capacity = *_size;
                 temp_array = new T[*_size];
-                std::memcpy(temp_array, _array, *_size * sizeof(T));
+                std::memcpy(temp_array, data(), *_size * sizeof(T));
                 swap();
             }
     }
@@ -302,11 +708,11 @@ namespace msh
     {
         for (size_t i = 0; i < _count; ++i)
         {
-            if (*(this + i)->_capacity > *(this + i)->_size)
+            if (!(this + i)->_mapping && *(this + i)->_capacity > *(this + i)->_size)
             {
                 *(this + i)->_capacity = *(this + i)->_size;
                 temp_array = new T[*_size];
-                std::memcpy(temp_array, _array, *_size * sizeof(T));
+                std::memcpy(temp_array, data(), *_size * sizeof(T));
                 swap();
             }
         }
@@ -316,11 +722,13 @@ namespace msh
     template <typename T>
     void shared_vector<T>::emplace_back(T &element)
     {
-        _array[*_size] = element;
-        ++(*_size);
-
-        if (*_size > *_capacity)
+        check_appendable();
+        if (!_count || *_size >= *_capacity)
             realloc();
+
+        data()[*_size] = element;
+        ++(*_size);
+        publish_size();
     }
 
     // Release the shared object and decrement the reference count
@@ -332,10 +740,23 @@ namespace msh
             --(*_count);
             if (*_count == 0)
             {
-                delete[] _array;
+                if (_mapping)
+                    detach();
+                else
+                {
+                    MSH_COUNT_DEALLOCATE(shared_vector<T>, *_capacity * sizeof(T));
+                    if (_epoch)
+                    {
+                        _epoch->domain->retire(data(), [](void *ptr) { delete[] static_cast<T *>(ptr); });
+                        delete _epoch;
+                    }
+                    else
+                        delete[] _array;
+                    delete _size;
+                    delete _capacity;
+                }
                 delete _count;
-                delete _size;
-                delete _capacity;
+                delete _growth;
                 delete allowIndexOutOfBound;
             }
             _array = nullptr;
@@ -343,7 +764,172 @@ namespace msh
             _size = nullptr;
             _capacity = nullptr;
             allowIndexOutOfBound = nullptr;
+            _growth = nullptr;
+            _mapping = nullptr;
+            _epoch = nullptr;
+        }
+    }
+
+    // Stop before appending to a published segment
+    template <typename T>
+    void shared_vector<T>::check_appendable() const
+    {
+        if (_mapping && _mapping->header->published.load(std::memory_order_relaxed))
+        {
+            LOG("A published segment cannot be appended to\nProgram terminated");
+            exit(1);
+        }
+    }
+
+    // Map the segment behind the file descriptor into this handle. Growable
+    // segments keep the descriptor open to be resized later.
+    template <typename T>
+    bool shared_vector<T>::map_segment(int fd, segment_open mode, bool growable, size_t capacity)
+    {
+        size_t page = growth_policy::page_size();
+        void *head = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (head == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+
+        segment_header *header = static_cast<segment_header *>(head);
+        if (mode == segment_open::create)
+        {
+            new (header) segment_header;
+            header->magic = segment_header::magic_number;
+            header->attached.store(0);
+            header->published.store(false);
+            header->size = 0;
+            header->capacity = capacity;
+            header->element_size = sizeof(T);
+        }
+        else
+        {
+            // A truncated or damaged file must not be mapped past its end
+            struct stat info;
+            bool valid = header->magic == segment_header::magic_number && header->element_size == sizeof(T) &&
+                         (mode != segment_open::attach || header->published.load(std::memory_order_acquire)) &&
+                         header->size <= header->capacity && fstat(fd, &info) == 0 &&
+                         header->capacity <= (SIZE_MAX - page) / sizeof(T) &&
+                         static_cast<size_t>(info.st_size) >= page + header->capacity * sizeof(T);
+            if (!valid)
+            {
+                munmap(head, page);
+                close(fd);
+                return false;
+            }
+        }
+
+        size_t bytes = header->capacity * sizeof(T);
+        void *data = nullptr;
+        if (bytes > 0)
+        {
+            data = mmap(nullptr, bytes, (mode == segment_open::attach ? PROT_READ : PROT_READ | PROT_WRITE), MAP_SHARED, fd, page);
+            if (data == MAP_FAILED)
+            {
+                munmap(head, page);
+                close(fd);
+                return false;
+            }
+        }
+        if (!growable)
+        {
+            close(fd);
+            fd = -1;
+        }
+
+        header->attached.fetch_add(1);
+        _mapping = new segment_mapping{header, data, bytes, fd};
+        _array = nullptr;
+        _count = new size_t(1);
+        _growth = new growth_policy();
+        _size = &header->size;
+        _capacity = &header->capacity;
+        return true;
+    }
+
+    // Unmap the segment and leave it to the other processes
+    template <typename T>
+    void shared_vector<T>::detach()
+    {
+        if (_mapping->data)
+            munmap(_mapping->data, _mapping->data_bytes);
+        _mapping->header->attached.fetch_sub(1);
+        munmap(_mapping->header, growth_policy::page_size());
+        if (_mapping->fd != -1)
+            close(_mapping->fd);
+        delete _mapping;
+    }
+
+    // Resize a file-backed segment, the mapping moves only if it cannot grow in place
+    template <typename T>
+    void shared_vector<T>::remap(size_t capacity)
+    {
+        size_t page = growth_policy::page_size();
+        size_t bytes = capacity * sizeof(T);
+
+        // Grow the file before the mapping, and shrink it after
+        if (bytes > _mapping->data_bytes && ftruncate(_mapping->fd, page + bytes) == -1)
+        {
+            LOG("Failed to grow the file of a vector\nProgram terminated");
+            exit(1);
         }
+
+        void *data = nullptr;
+        if (bytes == 0)
+        {
+            if (_mapping->data)
+                munmap(_mapping->data, _mapping->data_bytes);
+        }
+        else if (_mapping->data)
+            data = mremap(_mapping->data, _mapping->data_bytes, bytes, MREMAP_MAYMOVE);
+        else
+            data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _mapping->fd, page);
+        if (data == MAP_FAILED)
+        {
+            LOG("Failed to map the file of a vector\nProgram terminated");
+            exit(1);
+        }
+
+        if (bytes < _mapping->data_bytes && ftruncate(_mapping->fd, page + bytes) == -1)
+        {
+            LOG("Failed to shrink the file of a vector\nProgram terminated");
+            exit(1);
+        }
+
+        // Every handle reads the elements through the shared mapping
+        _mapping->data = data;
+        _mapping->data_bytes = bytes;
+    }
+
+    // Segment name with the leading slash required by shm_open
+    template <typename T>
+    std::string shared_vector<T>::shm_name(const std::string &name)
+    {
+        return (!name.empty() && name[0] == '/' ? name : '/' + name);
+    }
+
+    // Array readers should use: the published one in epoch mode, and the
+    // current mapping for segments, which mremap may have moved since this
+    // handle was copied
+    template <typename T>
+    inline T *shared_vector<T>::data() const
+    {
+        if (_epoch)
+            return _epoch->array.load(std::memory_order_acquire);
+        if (_mapping)
+            return static_cast<T *>(_mapping->data);
+        return _array;
+    }
+
+    // Make the current size visible to epoch-protected readers
+    template <typename T>
+    inline void shared_vector<T>::publish_size()
+    {
+        if (_epoch)
+            _epoch->size.store(*_size, std::memory_order_release);
     }
 
     // Reallocate the array
@@ -356,11 +942,29 @@ namespace msh
             this->_count = new size_t(1);
             this->_size = new size_t(0);
             this->_capacity = new size_t(1);
+            this->_growth = new growth_policy();
+            MSH_COUNT_ALLOCATE(shared_vector<T>, sizeof(T));
+        }
+        else if (_mapping && _mapping->fd == -1)
+        {
+            LOG("Shared memory segment cannot be resized\nProgram terminated");
+            exit(1);
+        }
+        else if (_mapping)
+        {
+            size_t capacity = (_capacity == 0 ? grown_capacity() : _capacity);
+            if (*(this->_size) > capacity)
+                *(this->_size) = capacity;
+            remap(capacity);
+            *(this->_capacity) = capacity;
+            return;
         }
 
+        MSH_COUNT_REALLOCATE(shared_vector<T>);
+        MSH_COUNT_DEALLOCATE(shared_vector<T>, *(this->_capacity) * sizeof(T));
         if (_capacity == 0)
         {
-            *(this->_capacity) += 1024;
+            *(this->_capacity) = grown_capacity();
         }
         else
         {
@@ -369,19 +973,93 @@ namespace msh
             *(this->_capacity) = _capacity;
         }
 
-        temp_array = new T[_capacity];
-        std::memcpy(temp_array, _array, *(this->_size) * sizeof(T));
+        MSH_COUNT_ALLOCATE(shared_vector<T>, *(this->_capacity) * sizeof(T));
+        MSH_COUNT_COPY(shared_vector<T>, *(this->_size) * sizeof(T));
+        temp_array = new T[*(this->_capacity)];
+        std::memcpy(temp_array, data(), *(this->_size) * sizeof(T));
         swap();
+        publish_size();
+    }
+
+    // Next capacity according to the growth policy
+    template <typename T>
+    size_t shared_vector<T>::grown_capacity() const
+    {
+        const growth_policy &growth = *_growth;
+        size_t current = *_capacity;
+        size_t next = current / growth.denominator * growth.numerator +
+                      current % growth.denominator * growth.numerator / growth.denominator;
+        if (next <= current)
+            next = current + 1;
+
+        if (growth.round_to > 0)
+        {
+            size_t bytes = next * sizeof(T);
+            bytes = (bytes + growth.round_to - 1) / growth.round_to * growth.round_to;
+            if (bytes / sizeof(T) > next)
+                next = bytes / sizeof(T);
+        }
+        return next;
     }
 
     // Swap the temperory array to _array
     template <typename T>
     void shared_vector<T>::swap()
     {
-        T *temp_ptr = _array;
+        T *temp_ptr = data();
         _array = temp_array;
-        delete[] temp_ptr;
         temp_array = nullptr;
+        if (_epoch)
+        {
+            // Readers still scanning the old array keep it alive
+            _epoch->array.store(_array, std::memory_order_release);
+            _epoch->domain->retire(temp_ptr, [](void *ptr) { delete[] static_cast<T *>(ptr); });
+        }
+        else
+            delete[] temp_ptr;
+    }
+
+    // ----------------------------->     SHARED_VIEW     <-----------------------------
+
+    // Read-only handle on a segment published by another process
+    template <typename T>
+    class shared_view
+    {
+        // ------------------->     Variables     <-------------------
+    private:
+        shared_vector<T> _vector;
+
+        // ------------------->      Methods      <-------------------
+    public:
+        // -----> Constructors and Destructor <-----
+        shared_view() = default;
+        explicit shared_view(const shared_vector<T> &vector) : _vector(vector) {}
+
+        // -----> Getters <-----
+        // Get size
+        size_t size() const { return _vector.size(); }
+        // Whether a published segment is attached
+        bool is_shared() const { return _vector.is_shared(); }
+        // Number of processes that have the segment mapped
+        size_t attach_count() const { return _vector.attach_count(); }
+        // Get the pointer to the elements
+        const T *get() const { return _vector.get(); }
+
+        // -----> Operators Overloading <-----
+        // Bracket(Index) operator
+        const T &operator[](size_t) const;
+    };
+
+    // Bracket(Index) operator
+    template <typename T>
+    const T &shared_view<T>::operator[](size_t index) const
+    {
+        if (index >= size())
+        {
+            LOG("index out of bound\nProgram terminated");
+            exit(1);
+        }
+        return get()[index];
     }
 
     // ----------------------------->     ARRAY     <-----------------------------
@@ -399,7 +1077,10 @@ namespace msh
         // -----> Constructors and Destructor <-----
         array() : _array(nullptr), _count(nullptr) {};
         // Constructor that creates a dynamic allocated vector using it's capacity
-        array(size_t count) : _array(new T[count]), _size(count), _count(new size_t(1)) {};
+        array(size_t count) : _array(new T[count]), _size(count), _count(new size_t(1))
+        {
+            MSH_COUNT_ALLOCATE(array<T>, count * sizeof(T));
+        };
         // Constructor that takes a pointer to a dynamically allocated object
         array(T *, size_t , size_t *);
         // Conversion constructor
@@ -521,6 +1202,7 @@ namespace msh
             --(*_count);
             if (*_count == 0)
             {
+                MSH_COUNT_DEALLOCATE(array<T>, _size * sizeof(T));
                 delete[] _array;
                 delete   _count;
             }
@@ -0,0 +1,290 @@
+#ifndef MSH_TAIL_READER_H
+#define MSH_TAIL_READER_H
+
+#include <iostream>
+#include <string>
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <type_traits>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "vector.h"
+
+#ifndef LOG
+#define LOG(x) std::cout << x << std::endl
+#endif
+#ifndef Print
+#define Print(x) std::cout << x << ' '
+#endif
+
+namespace msh
+{
+    // ----------------------------->     TAIL_READER     <-----------------------------
+
+    // Outputs a tail reader can append to
+    template <typename T>
+    struct is_vector : std::false_type {};
+    template <typename T>
+    struct is_vector<msh::vector<T>> : std::true_type {};
+
+    // Follows a file that producers keep appending rows to. Every poll reads
+    // only the bytes written since the previous one and appends the complete
+    // rows to the outputs; a trailing line without its '\n' is kept until the
+    // rest of it arrives. Rows are whitespace separated numbers, one row per
+    // line, as written by IO::write; a leading '+' is accepted as IO::read
+    // accepts it.
+    class tail_reader
+    {
+    // ------------------->     Variables     <-------------------
+    private:
+        std::string _file;
+        int fd{-1};
+        ino_t inode{0};
+        // Bytes of the file consumed so far, the partial line included
+        size_t _offset{0};
+        std::string _partial;
+        size_t _rows{0};
+        size_t _skipped{0};
+        int notify{-1};
+        int watch{-1};
+
+    // ------------------->      Methods      <-------------------
+    public:
+        // -----> Constructors and Destructor <-----
+        // The file does not have to exist yet
+        explicit tail_reader(const std::string &);
+        tail_reader(const tail_reader &) = delete;
+        tail_reader &operator=(const tail_reader &) = delete;
+        // Destructor
+        ~tail_reader();
+
+        // -----> Getters <-----
+        const std::string &file() const { return _file; }
+        // Bytes of the file consumed so far
+        size_t offset() const { return _offset; }
+        // Trailing bytes that do not make a whole line yet
+        const std::string &partial() const { return _partial; }
+        // Rows appended since construction or the last rewind
+        size_t rows() const { return _rows; }
+        // Lines dropped because they did not hold one number per output
+        size_t skipped() const { return _skipped; }
+
+        // -----> Other Methods <-----
+        // Append the rows written since the previous poll, returns how many
+        template <typename... Args>
+        size_t poll(Args&...);
+        // Block until the file changes or the timeout (milliseconds, -1 for
+        // none) runs out. Without inotify it just sleeps for the timeout.
+        bool wait(int timeout = -1);
+        // Start over from the beginning of the file on the next poll
+        void rewind();
+    private:
+        // Open the file if it exists and is not the one already open
+        bool open_file();
+        void close_file();
+        // Discard the pending change notifications
+        void drain();
+        // Parse the whole lines of a buffer, returns how many rows were appended
+        // and sets where the last line ends
+        template <typename... Args>
+        size_t parse(const std::string &, size_t &, Args&...);
+        // Parse one line into values, false if it does not hold exactly count numbers
+        static bool parse_line(const char *, const char *, double *, size_t);
+    };
+
+    // -----> Constructors and Destructor <-----
+    inline tail_reader::tail_reader(const std::string &file_address) : _file(file_address)
+    {
+        notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        open_file();
+    }
+    // Destructor
+    inline tail_reader::~tail_reader()
+    {
+        close_file();
+        if (notify != -1)
+            close(notify);
+    }
+
+    // -----> Other Methods <-----
+    // Append the rows written since the previous poll, returns how many. A file
+    // that shrank was truncated and is read again from its beginning; a file
+    // that was replaced (e.g. rotated) is finished first, then the new one is
+    // read from its beginning.
+    template <typename... Args>
+    size_t tail_reader::poll(Args&... args)
+    {
+        static_assert(sizeof...(Args) > 0, "a tail reader needs at least one output");
+        static_assert((is_vector<Args>::value && ...), "a tail reader appends to msh::vector outputs only");
+
+        // Changes so far are consumed here, so wait() only wakes up for later ones
+        drain();
+        size_t appended = 0;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (fd == -1 && !open_file())
+                return appended;
+
+            struct stat info;
+            if (fstat(fd, &info) != 0)
+                return appended;
+            if (static_cast<size_t>(info.st_size) < _offset)
+            {
+                _offset = 0;
+                _partial.clear();
+            }
+
+            std::string buffer;
+            buffer.swap(_partial);
+            size_t kept = buffer.size();
+            buffer.resize(kept + (static_cast<size_t>(info.st_size) - _offset));
+            ssize_t bytes = (buffer.size() > kept ? pread(fd, &buffer[kept], buffer.size() - kept, _offset) : 0);
+            if (bytes < 0)
+                bytes = 0;
+            buffer.resize(kept + static_cast<size_t>(bytes));
+            _offset += static_cast<size_t>(bytes);
+
+            size_t used = 0;
+            appended += parse(buffer, used, args...);
+            _partial.assign(buffer, used, std::string::npos);
+
+            // Switch to a file that took the place of the open one
+            struct stat current;
+            if (pass == 1 || stat(_file.c_str(), &current) != 0 || current.st_ino == inode)
+                break;
+            close_file();
+            _offset = 0;
+            _partial.clear();
+        }
+        return appended;
+    }
+    // Block until the file changes or the timeout (milliseconds, -1 for none)
+    // runs out, returns false on timeout
+    inline bool tail_reader::wait(int timeout)
+    {
+        if (notify == -1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout < 0 ? 100 : timeout));
+            return true;
+        }
+        if (watch == -1)
+            open_file();
+
+        // Until the file exists there is nothing to watch but the clock
+        if (watch == -1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout < 0 ? 100 : std::min(timeout, 100)));
+            return true;
+        }
+
+        struct pollfd ready = {notify, POLLIN, 0};
+        if (::poll(&ready, 1, timeout) <= 0)
+            return false;
+        drain();
+        return true;
+    }
+    // Start over from the beginning of the file on the next poll
+    inline void tail_reader::rewind()
+    {
+        _offset = 0;
+        _partial.clear();
+        _rows = 0;
+        _skipped = 0;
+    }
+    // Open the file if it exists and is not the one already open
+    inline bool tail_reader::open_file()
+    {
+        if (fd != -1)
+            return true;
+        fd = open(_file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0)
+            inode = info.st_ino;
+        if (notify != -1)
+            watch = inotify_add_watch(notify, _file.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+        return true;
+    }
+    // Discard the pending change notifications
+    inline void tail_reader::drain()
+    {
+        if (notify == -1)
+            return;
+        char events[4096];
+        while (read(notify, events, sizeof(events)) > 0)
+            ;
+    }
+    inline void tail_reader::close_file()
+    {
+        if (watch != -1)
+            inotify_rm_watch(notify, watch);
+        if (fd != -1)
+            close(fd);
+        watch = -1;
+        fd = -1;
+    }
+    // Parse the whole lines of a buffer, returns how many rows were appended
+    // and sets where the last line ends. Each line is parsed in full before any output grows, so the outputs
+    // always hold the same number of rows.
+    template <typename... Args>
+    size_t tail_reader::parse(const std::string &buffer, size_t &used, Args&... args)
+    {
+        const size_t count = sizeof...(Args);
+        double values[count];
+        size_t rows = 0;
+
+        const char *begin = buffer.data();
+        const char *p = begin;
+        const char *end = begin + buffer.size();
+        for (const char *eol; (eol = static_cast<const char *>(std::memchr(p, '\n', end - p))); p = eol + 1)
+        {
+            const char *q = p;
+            while (q < eol && std::isspace(static_cast<unsigned char>(*q)))
+                ++q;
+            if (q == eol)
+                continue;
+            if (!parse_line(q, eol, values, count))
+            {
+                ++_skipped;
+                continue;
+            }
+            size_t k = 0;
+            ((args[args.size()] = values[k++]), ...);
+            ++rows;
+        }
+        _rows += rows;
+        used = static_cast<size_t>(p - begin);
+        return rows;
+    }
+    // Parse one line into values, false if it does not hold exactly count numbers
+    inline bool tail_reader::parse_line(const char *p, const char *end, double *values, size_t count)
+    {
+        for (size_t k = 0; k < count; ++k)
+        {
+            while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+                ++p;
+            // from_chars does not take the sign operator>> accepts
+            if (p < end && *p == '+' && p + 1 < end && p[1] != '-' && p[1] != '+')
+                ++p;
+            std::from_chars_result parsed = std::from_chars(p, end, values[k]);
+            if (parsed.ec != std::errc())
+                return false;
+            p = parsed.ptr;
+        }
+        while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+            ++p;
+        return p == end;
+    }
+} // namespace msh
+
+#endif
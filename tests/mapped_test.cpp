@@ -0,0 +1,73 @@
+// File-backed msh::shared_vector: copies of a handle follow the mapping
+// when the original grows it, a persisted vector reopens intact, and a
+// truncated file is rejected instead of being mapped past its end.
+//
+//   g++ -O2 -std=c++17 -I.. mapped_test.cpp -o mapped_test -pthread && ./mapped_test
+
+#include <string>
+#include <sys/wait.h>
+#include "test.h"
+#include "../shared_vector.h"
+
+namespace
+{
+    // Run fn in a child process, true if it exited with 0
+    template <typename F>
+    bool in_child(F fn)
+    {
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+            _exit(fn() ? 0 : 1);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+} // namespace
+
+int main()
+{
+    const std::string path = "/tmp/msh_mapped_test.vec";
+    const size_t elements = 10000;
+
+    // Persist a vector and grow it far past its first mapping through one handle
+    {
+        msh::shared_vector<double> v = msh::shared_vector<double>::create_mapped(path, 16);
+        msh::shared_vector<double> copy(v);
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            double value = static_cast<double>(i);
+            v.emplace_back(value);
+        }
+        MSH_CHECK(copy.size() == 1000000);
+        MSH_CHECK(copy.get() == v.get());
+        MSH_CHECK(copy.get()[5] == 5);
+        MSH_CHECK(copy[999999] == 999999);
+    }
+
+    // Reopen a vector of known size
+    {
+        msh::shared_vector<double> v = msh::shared_vector<double>::create_mapped(path, elements);
+        v.set_permission(true);
+        for (size_t i = 0; i < elements; ++i)
+            v[i] = i * 0.5;
+        v.set_permission(false);
+        v.flush();
+    }
+    {
+        msh::shared_vector<double> v = msh::shared_vector<double>::open_mapped(path);
+        MSH_CHECK(v.size() == elements);
+        MSH_CHECK(v[elements - 1] == (elements - 1) * 0.5);
+    }
+
+    // Cutting off the second half must make the file unusable, not readable up to a SIGBUS
+    MSH_CHECK(truncate(path.c_str(), msh::growth_policy::page_size() + elements / 2 * sizeof(double)) == 0);
+    MSH_CHECK(!in_child([&path]()
+    {
+        msh::shared_vector<double> v = msh::shared_vector<double>::open_mapped(path);
+        return v.size() == elements;
+    }));
+
+    std::remove(path.c_str());
+    return msh::test::report("mapped_test");
+}
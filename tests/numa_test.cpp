@@ -0,0 +1,66 @@
+// NUMA placement of reserved blocks, checked against /proc/self/numa_maps.
+// On a single node every policy must fall back to ordinary local pages; on
+// several nodes interleaving must reach all of them.
+//
+//   g++ -O2 -std=c++17 -I.. numa_test.cpp -o numa_test -pthread && ./numa_test
+
+#define MSH_INSTRUMENT
+#include "test.h"
+#include "../shared_vector.h"
+
+namespace
+{
+    const size_t elements = 4 << 20;
+
+    // Nodes holding at least one resident page of the block
+    size_t nodes_used(const double *block)
+    {
+        std::vector<size_t> pages = msh::numa::resident_pages(block, elements * sizeof(double));
+        size_t used = 0;
+        for (size_t count : pages)
+            used += (count > 0);
+        return used;
+    }
+} // namespace
+
+int main()
+{
+    bool single_node = msh::numa::node_count() == 1;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    for (msh::numa::placement policy : {msh::numa::placement::first_touch, msh::numa::placement::interleave,
+                                        msh::numa::placement::partitioned})
+    {
+        // An empty handle gets its control block and the placed array, nothing else
+        msh::instrument::reset();
+        msh::shared_vector<double> v;
+        v.reserve(elements, policy, 4);
+        MSH_CHECK(msh::instrument::stats<msh::shared_vector<double>>().allocations == 1);
+        MSH_CHECK(v.capacity() == elements);
+        MSH_CHECK(v.size() == 0);
+
+        // Every page was touched while placing, so all of them are resident
+        std::vector<size_t> pages = msh::numa::resident_pages(v.get(), elements * sizeof(double));
+        size_t resident = 0;
+        for (size_t count : pages)
+            resident += count;
+        MSH_CHECK(resident >= elements * sizeof(double) / page);
+        MSH_CHECK(pages.size() <= msh::numa::nodes().back() + 1u);
+
+        if (single_node)
+            MSH_CHECK(nodes_used(v.get()) == 1);
+        else if (policy == msh::numa::placement::interleave)
+            MSH_CHECK(nodes_used(v.get()) == msh::numa::node_count());
+
+        // Growing with a placement keeps the elements
+        v.set_permission(true);
+        for (size_t i = 0; i < 1000; ++i)
+            v[i] = i * 0.5;
+        v.reserve(2 * elements, policy, 4);
+        MSH_CHECK(v.size() == 1000);
+        MSH_CHECK(v[999] == 999 * 0.5);
+        v.set_permission(false);
+    }
+
+    return msh::test::report("numa_test");
+}
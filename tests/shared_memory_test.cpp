@@ -0,0 +1,73 @@
+// Shared-memory segments across processes: a loader creates and publishes a
+// segment, forked readers attach to it, and unlink removes the name.
+//
+//   g++ -O2 -std=c++17 -I.. shared_memory_test.cpp -o shared_memory_test -pthread && ./shared_memory_test
+
+#include <string>
+#include <sys/wait.h>
+#include "test.h"
+#include "../shared_vector.h"
+
+namespace
+{
+    const size_t elements = 100000;
+
+    // Run fn in a child process, true if it exited with 0
+    template <typename F>
+    bool in_child(F fn)
+    {
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+            _exit(fn() ? 0 : 1);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    // Attach in the child and compare every element with what the loader wrote
+    bool reader()
+    {
+        msh::shared_view<double> view = msh::shared_vector<double>::attach_shared("msh_shared_memory_test");
+        if (!view.is_shared() || view.size() != elements || view.attach_count() < 2)
+            return false;
+        for (size_t i = 0; i < elements; ++i)
+            if (view[i] != i * 0.5)
+                return false;
+        return true;
+    }
+} // namespace
+
+int main()
+{
+    const std::string name = "msh_shared_memory_test";
+    msh::shared_vector<double>::unlink_shared(name);
+
+    msh::shared_vector<double> loader = msh::shared_vector<double>::create_shared(name, elements);
+    MSH_CHECK(loader.is_shared());
+    MSH_CHECK(loader.attach_count() == 1);
+
+    // Nothing can be attached before the loader publishes
+    MSH_CHECK(in_child([&name]() { return !msh::shared_vector<double>::attach_shared(name).is_shared(); }));
+
+    loader.set_permission(true);
+    for (size_t i = 0; i < elements; ++i)
+        loader[i] = i * 0.5;
+    loader.publish();
+
+    MSH_CHECK(in_child(reader));
+    MSH_CHECK(in_child(reader));
+    MSH_CHECK(loader.attach_count() == 1);
+
+    // Appending after publish would race with the readers, so it stops the program
+    MSH_CHECK(!in_child([&loader]() { double value = 1; loader.emplace_back(value); return true; }));
+    MSH_CHECK(loader.size() == elements);
+
+    // Mappings outlive the name
+    msh::shared_vector<double>::unlink_shared(name);
+    MSH_CHECK(in_child([&name]() { return !msh::shared_vector<double>::attach_shared(name).is_shared(); }));
+    MSH_CHECK(loader[elements - 1] == (elements - 1) * 0.5);
+
+    loader.set_permission(false);
+    return msh::test::report("shared_memory_test");
+}
@@ -0,0 +1,79 @@
+// msh::tail_reader following a file: partial lines wait for their end,
+// signed and malformed lines, truncation, rotation, and wait() waking up
+// only for changes made after the last poll.
+//
+//   g++ -O2 -std=c++17 -I.. tail_reader_test.cpp -o tail_reader_test -pthread && ./tail_reader_test
+
+#include <string>
+#include <fstream>
+#include "test.h"
+#include "../tail_reader.h"
+
+namespace
+{
+    void append(const std::string &path, const std::string &text)
+    {
+        std::ofstream file(path, std::ios::app | std::ios::binary);
+        file << text;
+    }
+    void replace(const std::string &path, const std::string &text)
+    {
+        std::ofstream file(path, std::ios::trunc | std::ios::binary);
+        file << text;
+    }
+} // namespace
+
+int main()
+{
+    std::string path = "/tmp/msh_tail_reader_test.txt";
+    std::string rotated = path + ".1";
+    std::remove(path.c_str());
+    std::remove(rotated.c_str());
+
+    msh::tail_reader reader(path);
+    msh::vector<double> a, b;
+
+    // Nothing to read before the file exists
+    MSH_CHECK(reader.poll(a, b) == 0);
+    replace(path, "");
+    MSH_CHECK(reader.poll(a, b) == 0);
+
+    // A line without its '\n' is kept until the rest of it arrives
+    append(path, "1 2\n3 ");
+    MSH_CHECK(reader.poll(a, b) == 1);
+    MSH_CHECK(reader.partial() == "3 ");
+    append(path, "4\n");
+    MSH_CHECK(reader.poll(a, b) == 1);
+    MSH_CHECK(reader.partial().empty());
+    MSH_CHECK(a.size() == 2 && a[1] == 3 && b[1] == 4);
+
+    // A leading '+' is a sign, anything else that is not a number drops the line
+    append(path, "+5 +6e1\n+-7 8\n9\nx 10\n");
+    MSH_CHECK(reader.poll(a, b) == 1);
+    MSH_CHECK(a[2] == 5 && b[2] == 60);
+    MSH_CHECK(reader.skipped() == 3);
+
+    // wait() only wakes up for changes made after the last poll
+    MSH_CHECK(!reader.wait(50));
+    append(path, "11 12\n");
+    MSH_CHECK(reader.wait(1000));
+    MSH_CHECK(reader.poll(a, b) == 1);
+    MSH_CHECK(!reader.wait(50));
+
+    // A truncated file is read again from its beginning
+    replace(path, "13 14\n");
+    MSH_CHECK(reader.poll(a, b) == 1);
+    MSH_CHECK(a[4] == 13 && b[4] == 14);
+
+    // A rotated file is finished before its replacement is read
+    append(path, "15 16\n");
+    MSH_CHECK(std::rename(path.c_str(), rotated.c_str()) == 0);
+    replace(path, "17 18\n");
+    MSH_CHECK(reader.poll(a, b) == 2);
+    MSH_CHECK(a[5] == 15 && a[6] == 17 && b[6] == 18);
+    MSH_CHECK(reader.rows() == 7 && a.size() == 7 && b.size() == 7);
+
+    std::remove(path.c_str());
+    std::remove(rotated.c_str());
+    return msh::test::report("tail_reader_test");
+}
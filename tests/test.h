@@ -0,0 +1,41 @@
+#ifndef MSH_TEST_H
+#define MSH_TEST_H
+
+#include <iostream>
+#include <string>
+
+// Record a failed check with its location and keep going, so one run
+// reports every broken expectation
+#define MSH_CHECK(condition) msh::test::check((condition), #condition, __FILE__, __LINE__)
+
+namespace msh
+{
+namespace test
+{
+    // Checks that failed so far
+    inline size_t &failures()
+    {
+        static size_t count = 0;
+        return count;
+    }
+
+    inline bool check(bool passed, const char *condition, const char *file, int line)
+    {
+        if (!passed)
+        {
+            ++failures();
+            std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+        }
+        return passed;
+    }
+
+    // Exit code of a test program: 0 when every check passed
+    inline int report(const std::string &name)
+    {
+        std::cout << name << ": " << (failures() == 0 ? "passed" : "FAILED") << std::endl;
+        return (failures() == 0 ? 0 : 1);
+    }
+} // namespace test
+} // namespace msh
+
+#endif
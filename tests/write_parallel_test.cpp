@@ -0,0 +1,68 @@
+// IO::write_parallel must produce the same bytes as IO::write for every
+// thread count, chunk size and write mode.
+//
+//   g++ -O2 -std=c++17 -I.. write_parallel_test.cpp -o write_parallel_test -pthread && ./write_parallel_test
+
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include "test.h"
+#include "../IO.h"
+
+namespace
+{
+    std::string contents(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+} // namespace
+
+int main()
+{
+    std::string serial_path = "/tmp/msh_write_parallel_serial.txt";
+    std::string parallel_path = "/tmp/msh_write_parallel.txt";
+    msh::IO io;
+
+    for (size_t rows : {1, 7, 1000, 100003})
+    {
+        // Doubles that print in every notation, next to integers
+        msh::vector<double> reals;
+        msh::vector<int> integers;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            reals[i] = std::sin(static_cast<double>(i)) * std::pow(10.0, static_cast<double>(i % 13) - 6);
+            integers[i] = static_cast<int>(i) - 500;
+        }
+        msh::array<double> a;
+        msh::array<int> b;
+        a = reals;
+        b = integers;
+
+        io.write(serial_path, a, b);
+        std::string expected = contents(serial_path);
+
+        for (size_t threads : {1, 2, 3, 7, 8})
+            for (size_t chunk_rows : {1, 1000, 65536})
+                for (bool positioned : {false, true})
+                {
+                    if (chunk_rows == 1 && rows > 1000)
+                        continue;
+                    msh::write_options options;
+                    options.threads = threads;
+                    options.chunk_rows = chunk_rows;
+                    options.positioned = positioned;
+                    io.write_parallel(parallel_path, options, a, b);
+                    if (!MSH_CHECK(contents(parallel_path) == expected))
+                        std::cerr << "  rows " << rows << ", threads " << threads << ", chunk_rows " << chunk_rows
+                                  << ", positioned " << positioned << std::endl;
+                }
+    }
+
+    std::remove(serial_path.c_str());
+    std::remove(parallel_path.c_str());
+    return msh::test::report("write_parallel_test");
+}
@@ -0,0 +1,77 @@
+// Zone maps saved by IO::write and IO::write_parallel describe the values a
+// read gets back from the file, so range scans after a read match a brute
+// force scan even where printing rounded the values.
+//
+//   g++ -O2 -std=c++17 -I.. zone_map_test.cpp -o zone_map_test -pthread && ./zone_map_test
+
+#include <cmath>
+#include <string>
+#include "test.h"
+#include "../IO.h"
+
+namespace
+{
+    const size_t rows = 20000;
+    const size_t block_size = 64;
+
+    // Read the file back and compare range scans over its zone maps with brute force
+    void check_round_trip(msh::IO &io, std::string &path, const char *how)
+    {
+        msh::array<double> a;
+        msh::array<int> b;
+        if (!MSH_CHECK(io.read(path, a, b) == rows))
+            return;
+        if (!MSH_CHECK(io.zone_maps().size() == 2 && io.zone_maps()[0].size() == rows))
+            return;
+        const msh::zone_map<double> &map = io.zone_maps()[0];
+
+        // Bounds that sit exactly on printed values, between them, and around the rounding
+        for (double low : {0.0, 0.5, 1.0, 1.00001, 2.46913, 10.0})
+            for (double width : {0.0, 0.000001, 0.5, 3.0})
+            {
+                double high = low + width;
+                size_t expected = 0;
+                for (size_t i = 0; i < rows; ++i)
+                    expected += (a[i] >= low && a[i] <= high);
+                size_t found = map.range_scan(a, low, high, [](size_t, double) {});
+                if (!MSH_CHECK(found == expected))
+                    std::cerr << "  " << how << " [" << low << ", " << high << "]: " << found << " of " << expected
+                              << std::endl;
+            }
+    }
+} // namespace
+
+int main()
+{
+    std::string path = "/tmp/msh_zone_map_test.txt";
+    msh::IO io;
+    io.enable_zone_maps(block_size);
+
+    // Whole blocks of values with more than 6 significant digits, so rounding
+    // moves every minimum and maximum of a block
+    msh::vector<double> reals;
+    msh::vector<int> integers;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        size_t block = i / block_size;
+        reals[i] = (block % 4 == 0 ? 1.0000004 : (block % 4 == 1 ? 0.9999996 : 1.2345678 * static_cast<double>(block % 9)));
+        integers[i] = static_cast<int>(i);
+    }
+    msh::array<double> a;
+    msh::array<int> b;
+    a = reals;
+    b = integers;
+
+    io.write(path, a, b);
+    check_round_trip(io, path, "write");
+
+    msh::write_options options;
+    options.threads = 4;
+    options.chunk_rows = 1000;
+    io.write_parallel(path, options, a, b);
+    check_round_trip(io, path, "write_parallel");
+
+    std::remove(path.c_str());
+    std::remove(msh::zone_map_file(path).c_str());
+    return msh::test::report("zone_map_test");
+}
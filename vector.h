@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <cstring>
+#include "instrument.h"
+#include "numa.h"
 
 #ifndef LOG
 #define LOG(x) std::cout << x << std::endl
@@ -29,6 +31,8 @@ namespace msh
         T *_array;
         size_t _size;
         size_t _capacity;
+        // Times the block was replaced by a larger or smaller one
+        size_t _reallocations{0};
 
     // ------------------->      Methods      <-------------------
     public:
@@ -36,7 +40,10 @@ namespace msh
         // Default Constructor
         vector() : _array(nullptr),  _size(0), _capacity(0) {}
         // Constructor that creates a dynamic allocated vector using it's capacity
-        vector(const size_t _capacity) : _array(new T[_capacity]),  _size(0), _capacity(_capacity) {}
+        vector(const size_t _capacity) : _array(new T[_capacity]),  _size(0), _capacity(_capacity)
+        {
+            MSH_COUNT_ALLOCATE(vector<T>, _capacity * sizeof(T));
+        }
         // Destructor
         ~vector();
 
@@ -47,6 +54,8 @@ namespace msh
         size_t size() const;
         // Get capacity
         size_t capacity() const;
+        // Get the number of times the block was replaced since construction or reset
+        size_t reallocations() const;
 
         // -----> Operators Overloading <-----
         // Assignment Operator
@@ -59,6 +68,8 @@ namespace msh
         // -----> Other Methods <-----
         // Reserve a block of memory
         void reserve(const size_t);
+        // Reserve a block of memory whose pages are placed over the NUMA nodes
+        void reserve(const size_t, numa::placement, size_t threads = 0);
         // Remove last element
         void pop();
         // Reset size
@@ -79,6 +90,8 @@ namespace msh
     template <typename T>
     vector<T>::~vector()
     {
+        if (_array)
+            MSH_COUNT_DEALLOCATE(vector<T>, _capacity * sizeof(T));
         delete[] _array;
     }
 
@@ -102,6 +115,13 @@ namespace msh
         return _capacity;
     }
 
+    // Get the number of times the block was replaced since construction or reset
+    template <typename T>
+    inline size_t vector<T>::reallocations() const
+    {
+        return _reallocations;
+    }
+
     // -----> Operators Overloading <-----
     // Assignment Operator
     template <typename T>
@@ -112,10 +132,14 @@ namespace msh
             _size = other._size;
             if (_capacity != other._capacity)
             {
-                _capacity = other._capacity;
                 if (_array)
+                {
+                    MSH_COUNT_DEALLOCATE(vector<T>, _capacity * sizeof(T));
                     delete[] _array;
+                }
+                _capacity = other._capacity;
                 _array = new T[_capacity];
+                MSH_COUNT_ALLOCATE(vector<T>, _capacity * sizeof(T));
             }
             copy_elements(other._array);
         }
@@ -126,9 +150,11 @@ namespace msh
     inline T &vector<T>::operator[](const size_t index)
     {
         if (index == _size)
+        {
+            if (_size == _capacity)
+                realloc(_capacity ? 2 * _capacity : 1);
             ++_size;
-        if (_size > _capacity)
-            realloc(2 * _capacity);
+        }
 
         return _array[index];
     }
@@ -150,7 +176,31 @@ namespace msh
         {
             this->_capacity = _capacity;
             _array = new T[_capacity];
+            MSH_COUNT_ALLOCATE(vector<T>, _capacity * sizeof(T));
+        }
+    }
+    // Reserve a block of memory whose pages are placed over the NUMA nodes.
+    // The new block is placed before the current elements are copied into it.
+    template <typename T>
+    void vector<T>::reserve(const size_t _capacity, numa::placement policy, size_t threads)
+    {
+        T *block = new T[_capacity];
+        numa::place(block, _capacity, policy, threads);
+        MSH_COUNT_ALLOCATE(vector<T>, _capacity * sizeof(T));
+
+        T *temp = _array;
+        _array = block;
+        if (temp)
+        {
+            ++_reallocations;
+            MSH_COUNT_REALLOCATE(vector<T>);
+            MSH_COUNT_DEALLOCATE(vector<T>, this->_capacity * sizeof(T));
+            if (_size > _capacity)
+                _size = _capacity;
+            copy_elements(temp);
+            delete[] temp;
         }
+        this->_capacity = _capacity;
     }
     // Remove last element
     template <typename T>
@@ -170,11 +220,13 @@ namespace msh
     {
         if (_array)
         {
+            MSH_COUNT_DEALLOCATE(vector<T>, _capacity * sizeof(T));
             delete[] _array;
             _array = nullptr;
         }
         _size     = 0;
         _capacity = 0;
+        _reallocations = 0;
     }
     // Reallocate block of memory
     template <typename T>
@@ -182,6 +234,14 @@ namespace msh
     {
         if (this->_capacity != _capacity)
         {
+            // A vector without a block only allocates its first one
+            if (_array)
+            {
+                ++_reallocations;
+                MSH_COUNT_REALLOCATE(vector<T>);
+                MSH_COUNT_DEALLOCATE(vector<T>, this->_capacity * sizeof(T));
+            }
+            MSH_COUNT_ALLOCATE(vector<T>, _capacity * sizeof(T));
             this->_capacity = _capacity;
             if (_size > _capacity)
                 _size = _capacity;
@@ -196,6 +256,7 @@ namespace msh
     template <typename T>
     void vector<T>::copy_elements(T *const other_array)
     {
+        MSH_COUNT_COPY(vector<T>, _size * sizeof(T));
         for (size_t i = 0; i < _size; ++i)
             _array[i] = other_array[i];
     }
@@ -220,7 +281,10 @@ namespace msh
         // -----> Constructors and Destructor <-----
         // Default Constructor
         array() : _array(nullptr), _size(0) {}
-        array(const size_t _size) : _array(new T[_size]), _size(_size) {}
+        array(const size_t _size) : _array(new T[_size]), _size(_size)
+        {
+            MSH_COUNT_ALLOCATE(array<T>, _size * sizeof(T));
+        }
         // Destructor
         ~array();
 
@@ -230,7 +294,8 @@ namespace msh
 
         // -----> Operators Overloading <-----
         // Assignment Operator
-        array<T> &operator=(const vector<double> &other);
+        template <typename U>
+        array<T> &operator=(const vector<U> &other);
         // Bracket(Index) Operator
         T &operator[](size_t);
     };
@@ -240,6 +305,8 @@ namespace msh
     template <typename T>
     array<T>::~array()
     {
+        if (_array)
+            MSH_COUNT_DEALLOCATE(array<T>, _size * sizeof(T));
         delete[] _array;
     }
 
@@ -254,17 +321,23 @@ namespace msh
     // -----> Operators Overloading <-----
     // Assignment Operator
     template <typename T>
-    array<T> &array<T>::operator=(const vector<double> &other)
+    template <typename U>
+    array<T> &array<T>::operator=(const vector<U> &other)
     {
         // if (_array != other.get())
         {
             if (_size != other.size())
             {
-                _size = other.size();
                 if (_array)
+                {
+                    MSH_COUNT_DEALLOCATE(array<T>, _size * sizeof(T));
                     delete[] _array;
+                }
+                _size = other.size();
                 _array = new T[_size];
+                MSH_COUNT_ALLOCATE(array<T>, _size * sizeof(T));
             }
+            MSH_COUNT_COPY(array<T>, _size * sizeof(T));
             // std::memcpy(_array, other.get(), _size * sizeof(T));
             for (size_t i = 0; i < _size; ++i)
                 _array[i] = static_cast<T>(other.get()[i]);
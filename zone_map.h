@@ -0,0 +1,300 @@
+#ifndef MSH_ZONE_MAP_H
+#define MSH_ZONE_MAP_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <sys/stat.h>
+
+#ifndef LOG
+#define LOG(x) std::cout << x << std::endl
+#endif
+#ifndef Print
+#define Print(x) std::cout << x << ' '
+#endif
+
+namespace msh
+{
+    // ----------------------------->     ZONE_MAP     <-----------------------------
+
+    // Minimum, maximum and counts of every fixed-size block of a column, so a
+    // range scan can skip the blocks that cannot hold a match. It is built one
+    // value at a time, in the same pass that produces the column.
+    template <typename T>
+    class zone_map
+    {
+        static_assert(std::is_arithmetic<T>::value, "zone maps need an arithmetic type");
+
+    // ------------------->     Variables     <-------------------
+    public:
+        struct block
+        {
+            T min;
+            T max;
+            // Values in the block, NaNs included
+            uint64_t count;
+            uint64_t nan_count;
+        };
+    private:
+        size_t _block_size;
+        size_t _size{0};
+        std::vector<block> _blocks;
+
+    // ------------------->      Methods      <-------------------
+    public:
+        // -----> Constructors and Destructor <-----
+        explicit zone_map(size_t block_size = 4096) : _block_size(block_size ? block_size : 1) {}
+
+        // -----> Getters <-----
+        // Rows per block
+        size_t block_size() const { return _block_size; }
+        // Rows covered
+        size_t size() const { return _size; }
+        // Number of blocks
+        size_t blocks() const { return _blocks.size(); }
+        // Statistics of one block
+        const block &operator[](size_t index) const { return _blocks[index]; }
+
+        // -----> Building <-----
+        // Account for the next value of the column
+        void add(T);
+        // Build from the first count values of a column (msh::array, msh::vector...)
+        template <typename C>
+        void build(C &, size_t);
+        // Forget every block
+        void clear();
+
+        // -----> Scanning <-----
+        // Call fn(begin, end) for each run of rows whose blocks may hold values in [low, high]
+        template <typename F>
+        void candidates(T, T, F) const;
+        // Call fn(row, value) for each value of the column in [low, high], returns how many
+        template <typename C, typename F>
+        size_t range_scan(C &, T, T, F) const;
+        // Rows a range scan over [low, high] skips
+        size_t skipped_rows(T, T) const;
+
+        // -----> Persistence <-----
+        void save(std::ostream &) const;
+        bool load(std::istream &);
+
+    private:
+        // Whether a block may hold a value in [low, high]
+        bool may_match(const block &, T, T) const;
+    };
+
+    // -----> Building <-----
+    // Account for the next value of the column
+    template <typename T>
+    void zone_map<T>::add(T value)
+    {
+        if (_size % _block_size == 0)
+            _blocks.push_back({T(), T(), 0, 0});
+        ++_size;
+
+        block &last = _blocks.back();
+        if (value != value)
+            ++last.nan_count;
+        else if (last.count == last.nan_count)
+        {
+            last.min = value;
+            last.max = value;
+        }
+        else
+        {
+            if (value < last.min)
+                last.min = value;
+            if (value > last.max)
+                last.max = value;
+        }
+        ++last.count;
+    }
+
+    // Build from the first count values of a column (msh::array, msh::vector...)
+    template <typename T>
+    template <typename C>
+    void zone_map<T>::build(C &column, size_t count)
+    {
+        clear();
+        _blocks.reserve((count + _block_size - 1) / _block_size);
+        for (size_t i = 0; i < count; ++i)
+            add(static_cast<T>(column[i]));
+    }
+
+    // Forget every block
+    template <typename T>
+    void zone_map<T>::clear()
+    {
+        _size = 0;
+        _blocks.clear();
+    }
+
+    // -----> Scanning <-----
+    // Call fn(begin, end) for each run of rows whose blocks may hold values in [low, high].
+    // Adjacent candidate blocks are merged into one run.
+    template <typename T>
+    template <typename F>
+    void zone_map<T>::candidates(T low, T high, F fn) const
+    {
+        size_t begin = 0;
+        bool open = false;
+        for (size_t b = 0; b < _blocks.size(); ++b)
+        {
+            bool match = may_match(_blocks[b], low, high);
+            if (match && !open)
+            {
+                begin = b * _block_size;
+                open = true;
+            }
+            else if (!match && open)
+            {
+                fn(begin, b * _block_size);
+                open = false;
+            }
+        }
+        if (open)
+            fn(begin, _size);
+    }
+
+    // Call fn(row, value) for each value of the column in [low, high], returns how many
+    template <typename T>
+    template <typename C, typename F>
+    size_t zone_map<T>::range_scan(C &column, T low, T high, F fn) const
+    {
+        size_t matches = 0;
+        candidates(low, high, [&](size_t begin, size_t end)
+        {
+            for (size_t row = begin; row < end; ++row)
+            {
+                T value = static_cast<T>(column[row]);
+                if (value >= low && value <= high)
+                {
+                    fn(row, value);
+                    ++matches;
+                }
+            }
+        });
+        return matches;
+    }
+
+    // Rows a range scan over [low, high] skips
+    template <typename T>
+    size_t zone_map<T>::skipped_rows(T low, T high) const
+    {
+        size_t scanned = 0;
+        candidates(low, high, [&scanned](size_t begin, size_t end) { scanned += end - begin; });
+        return _size - scanned;
+    }
+
+    // Whether a block may hold a value in [low, high]
+    template <typename T>
+    inline bool zone_map<T>::may_match(const block &zone, T low, T high) const
+    {
+        return zone.count > zone.nan_count && zone.max >= low && zone.min <= high;
+    }
+
+    // -----> Persistence <-----
+    // Layout: block size, rows, element size, then the blocks as stored in memory
+    template <typename T>
+    void zone_map<T>::save(std::ostream &os) const
+    {
+        uint64_t header[3] = {_block_size, _size, sizeof(T)};
+        os.write(reinterpret_cast<const char *>(header), sizeof(header));
+        os.write(reinterpret_cast<const char *>(_blocks.data()), _blocks.size() * sizeof(block));
+    }
+
+    template <typename T>
+    bool zone_map<T>::load(std::istream &is)
+    {
+        uint64_t header[3];
+        if (!is.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] == 0 || header[2] != sizeof(T))
+            return false;
+
+        std::vector<block> blocks((header[1] + header[0] - 1) / header[0]);
+        if (!is.read(reinterpret_cast<char *>(blocks.data()), blocks.size() * sizeof(block)))
+            return false;
+
+        _block_size = header[0];
+        _size = header[1];
+        _blocks.swap(blocks);
+        return true;
+    }
+
+    // ----------------------------->     SIDECAR FILES     <-----------------------------
+
+    // Name of the file that keeps the zone maps of a data file
+    inline std::string zone_map_file(const std::string &file_address)
+    {
+        return file_address + ".zmap";
+    }
+
+    // Size and modification time of a data file, as recorded in its sidecar
+    inline bool zone_map_stamp(const std::string &file_address, uint64_t (&stamp)[3])
+    {
+        struct stat info;
+        if (stat(file_address.c_str(), &info) != 0)
+            return false;
+        stamp[0] = static_cast<uint64_t>(info.st_size);
+        stamp[1] = static_cast<uint64_t>(info.st_mtim.tv_sec);
+        stamp[2] = static_cast<uint64_t>(info.st_mtim.tv_nsec);
+        return true;
+    }
+
+    // Save the zone maps of every column of a data file next to it, stamped
+    // with the size and modification time of the data file
+    template <typename T>
+    bool save_zone_maps(const std::string &file_address, const std::vector<zone_map<T>> &maps)
+    {
+        uint64_t stamp[3];
+        if (!zone_map_stamp(file_address, stamp))
+            return false;
+        std::ofstream File(zone_map_file(file_address), std::ios::out | std::ios::binary);
+        if (!File.is_open())
+            return false;
+
+        const char magic[8] = {'M', 'S', 'H', 'Z', 'M', 'A', 'P', '2'};
+        uint64_t columns = maps.size();
+        File.write(magic, sizeof(magic));
+        File.write(reinterpret_cast<const char *>(stamp), sizeof(stamp));
+        File.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+        for (const zone_map<T> &map : maps)
+            map.save(File);
+        return static_cast<bool>(File);
+    }
+
+    // Load the zone maps saved next to a data file, false if there are none
+    // for this many columns or the data file changed since they were saved.
+    // Size and modification time must match exactly, so a sidecar copied
+    // along with an older version of the data is never trusted.
+    template <typename T>
+    bool load_zone_maps(const std::string &file_address, std::vector<zone_map<T>> &maps, size_t columns)
+    {
+        uint64_t current[3];
+        if (!zone_map_stamp(file_address, current))
+            return false;
+        std::ifstream File(zone_map_file(file_address), std::ios::in | std::ios::binary);
+        if (!File.is_open())
+            return false;
+
+        char magic[8];
+        uint64_t stamp[3];
+        uint64_t count;
+        if (!File.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != "MSHZMAP2" ||
+            !File.read(reinterpret_cast<char *>(stamp), sizeof(stamp)) ||
+            stamp[0] != current[0] || stamp[1] != current[1] || stamp[2] != current[2] ||
+            !File.read(reinterpret_cast<char *>(&count), sizeof(count)) || count != columns)
+            return false;
+
+        std::vector<zone_map<T>> loaded(columns);
+        for (zone_map<T> &map : loaded)
+            if (!map.load(File))
+                return false;
+        maps.swap(loaded);
+        return true;
+    }
+} // namespace msh
+
+#endif